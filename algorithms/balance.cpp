@@ -18,89 +18,98 @@ double fill_water(vector<double> &level, const double water)
 
 // Match by sampling without replacement
 // with weight computed by balance
-vector<int> graph::balance_swor()
+const vector<int> &graph::balance_swor(workspace &ws)
 {
-    vector<double> currentLevel(onSize + offSize, 0);
-    vector<bool> selected(onSize + offSize, false);
-    vector<int> res(realSize, -1);
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_array<double> &currentLevel = ws.level;
+    epoch_flags &selected = ws.matched;
+    vector<double> &level = ws.real1;
+    if (from == 0)
+        currentLevel.reset(onSize + offSize, 0);
 
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
-        vector<double> level;
+        level.clear();
 
         for (int j : adj[types[i]])
-            level.push_back(currentLevel[j]);
+            level.push_back(currentLevel.get(j));
 
         double newLevel = fill_water(level, 1);
 
         double mass = 0, chosen = 0;
-        vector<pair<int, double>> validMass;
         for (int j : adj[types[i]])
-            if (not selected[j])
-                mass += max(newLevel - currentLevel[j], 0.0);
+            if (not selected.test(j))
+                mass += max(newLevel - currentLevel.get(j), 0.0);
 
         std::uniform_real_distribution<double> dist(0, mass);
-        double sample = dist(rng);
+        double sample = dist(ws.gen);
 
         for (int j : adj[types[i]])
-            if (not selected[j])
+            if (not selected.test(j))
             {
-                chosen += max(newLevel - currentLevel[j], 0.0);
+                chosen += max(newLevel - currentLevel.get(j), 0.0);
                 if (chosen >= sample)
                 {
-                    selected[j] = true;
+                    selected.set(j);
                     res[i] = j;
                     break;
                 }
             }
         for (int j : adj[types[i]])
-            currentLevel[j] = max(newLevel, currentLevel[j]);
+            currentLevel.set(j, max(newLevel, currentLevel.get(j)));
     }
     return res;
 }
 
 // Match by OCS, Huang et al. (2020)
 // with weight computed by balance
-vector<int> graph::balance_ocs()
+const vector<int> &graph::balance_ocs(workspace &ws)
 {
-    vector<double> currentLevel(onSize + offSize, 0);
-    vector<bool> selected(onSize + offSize, false);
-    vector<int> res(realSize, -1);
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_array<double> &currentLevel = ws.level;
+    epoch_flags &selected = ws.matched;
+    vector<double> &level = ws.real1;
+    if (from == 0)
+        currentLevel.reset(onSize + offSize, 0);
     auto w = [](double y)
     {
         double c = (4 - 2 * sqrt(3)) / 3;
         return exp(1.0 * y + y * y / 2.0 + c * y * y * y);
     };
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
-        vector<double> level;
+        level.clear();
 
         for (int j : adj[types[i]])
-            level.push_back(currentLevel[j]);
+            level.push_back(currentLevel.get(j));
 
         double newLevel = fill_water(level, 1);
 
         double mass = 0, chosen = 0;
         for (int j : adj[types[i]])
-            if (not selected[j])
-                mass += max((newLevel - currentLevel[j]), 0.0) * w(currentLevel[j]);
+            if (not selected.test(j))
+                mass += max((newLevel - currentLevel.get(j)), 0.0) * w(currentLevel.get(j));
 
         std::uniform_real_distribution<double> dist(0, mass);
-        double sample = dist(rng);
+        double sample = dist(ws.gen);
 
         for (int j : adj[types[i]])
-            if (not selected[j])
+            if (not selected.test(j))
             {
-                chosen += max(newLevel - currentLevel[j], 0.0) * w(currentLevel[j]);
+                chosen += max(newLevel - currentLevel.get(j), 0.0) * w(currentLevel.get(j));
                 if (chosen >= sample)
                 {
-                    selected[j] = true;
+                    selected.set(j);
                     res[i] = j;
                     break;
                 }
             }
         for (int j : adj[types[i]])
-            currentLevel[j] = max(newLevel, currentLevel[j]);
+            currentLevel.set(j, max(newLevel, currentLevel.get(j)));
     }
     return res;
 }
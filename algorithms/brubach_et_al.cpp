@@ -71,6 +71,85 @@ map<pair<int, int>, double> graph::brubach_et_al_lp()
     return res;
 }
 
+// Compute LP in Brubach et al. (2016) on twin classes, with one variable per class edge
+// An online class of k types adjacent to an offline class of l vertices gives k * l edges of equal value y:
+// y counts l times in the row of an online type, k times in the row of an offline vertex and k * l times in the objective,
+// and two twin types adjacent to the same offline vertex bound 2y by 1 - e^-2
+map<pair<int, int>, double> graph::brubach_et_al_lp(const twin_classes &twins)
+{
+    const vector<vector<int>> &cAdj = twins.adj;
+    const vector<long long> &mult = twins.mult;
+    int cOn = twins.numOnline, cAll = cOn + twins.numOffline;
+
+    vector<int> ia, ja;
+    vector<double> ar;
+    vector<map<int, int>> eID(cOn);
+
+    ia.push_back(-1); ja.push_back(-1); ar.push_back(-1.0);
+
+    glp_prob *lp = glp_create_prob();
+    glp_set_obj_dir(lp, GLP_MAX);
+    glp_term_out(GLP_OFF);
+
+    int nRow = cAll;
+    glp_add_rows(lp, nRow);
+    for (int i = 1; i <= nRow; i++)
+        glp_set_row_bnds(lp, i, GLP_UP, 0.0, 1.0);
+
+    for (int i = 0; i < cOn; i++)
+        if (cAdj[i].size())
+            glp_add_cols(lp, cAdj[i].size());
+
+    int num = 0;
+    for (int i = 0; i < cOn; i++)
+        for (int j : cAdj[i])
+        {
+            num++;
+            eID[i][j] = num;
+
+            ia.push_back(i + 1);
+            ja.push_back(num);
+            ar.push_back(mult[j]);
+
+            ia.push_back(j + 1);
+            ja.push_back(num);
+            ar.push_back(mult[i]);
+
+            glp_set_col_bnds(lp, num, GLP_DB, 0.0, mult[i] > 1 ? (1.0 - exp(-2.0)) / 2 : 1.0 - exp(-1.0));
+            glp_set_obj_coef(lp, num, (double)mult[i] * mult[j]);
+        }
+
+    for (int j = cOn; j < cAll; j++)
+        for (int i1 : cAdj[j]) for (int i2 : cAdj[j])
+            if (i1 < i2)
+            {
+                nRow++;
+                glp_add_rows(lp, 1);
+                glp_set_row_bnds(lp, nRow, GLP_UP, 0.0, 1.0 - exp(-2.0));
+
+                ia.push_back(nRow);
+                ja.push_back(eID[i1][j]);
+                ar.push_back(1.0);
+
+                ia.push_back(nRow);
+                ja.push_back(eID[i2][j]);
+                ar.push_back(1.0);
+            }
+
+    glp_load_matrix(lp, (int)ia.size() - 1, &ia[0], &ja[0], &ar[0]);
+
+    glp_simplex(lp, NULL);
+
+    map<pair<int, int>, double> res;
+
+    for (int i = 0; i < cOn; i++)
+        for (int j : cAdj[i])
+            res[make_pair(i, j)] = glp_get_col_prim(lp, eID[i][j]);
+
+    glp_delete_prob(lp);
+    return twins.expand(adj, res);
+}
+
 // Compute H' in Brubach et al. (2016)
 vector<vector<pair<int, double>>> graph::brubach_et_al_h(map<pair<int, int>, double> &lpSol)
 {
@@ -181,73 +260,70 @@ vector<vector<pair<int, double>>> graph::brubach_et_al_h(map<pair<int, int>, dou
     return res;
 }
 
-// Match online vertices with weight H'
-vector<int> graph::brubach_et_al(vector<vector<pair<int, double>>> h)
+// Compile H' into a table of probing orders with cumulative probabilities
+// Orders of a type with two neighbours are normalized, as in sampling proportional to H'
+// Orders of a type with three neighbours are not, so with the remaining probability nothing is probed
+permutation_table graph::brubach_et_al_table(const vector<vector<pair<int, double>>> &h)
 {
-    vector<int> res(realSize, -1);
-    vector<bool> matched(offSize + onSize, false);
-
-    
-
-    for (int i = 0; i < realSize; i++)
+    permutation_table table;
+    for (int i = 0; i < onSize; i++)
     {
-        auto hI = h[types[i]];
-        vector<int> list = {};
+        const vector<pair<int, double>> &hI = h[i];
         if (hI.size() == 1)
         {
-            int v1 = hI[0].first;
-            list.push_back(v1);
+            table.add_order(hI[0].first, -1, -1, 1.0);
         }
         else if (hI.size() == 2)
         {
             int v1 = hI[0].first, v2 = hI[1].first;
             double x1 = hI[0].second, x2 = hI[1].second;
             
-            uniform_real_distribution<double> curRand(0.0, x1 + x2);
-            if (curRand(rng) <= x1)
-            {
-                list.push_back(v1);
-                list.push_back(v2);
-            }
-            else
-            {
-                list.push_back(v2);
-                list.push_back(v1);
-            }
+            table.add_order(v1, v2, -1, x1 / (x1 + x2));
+            table.add_order(v2, v1, -1, x2 / (x1 + x2));
         }
         else if (hI.size() == 3)
         {
             int v1 = hI[0].first, v2 = hI[1].first, v3 = hI[2].first;
             double x1 = hI[0].second, x2 = hI[1].second, x3 = hI[2].second;
             
-            vector<pair<vector<int>, double>> sampleList = {};
-            sampleList.push_back(make_pair(vector<int>{v1, v2, v3}, x1 * x2 / (x2 + x3)));
-            sampleList.push_back(make_pair(vector<int>{v1, v3, v2}, x1 * x3 / (x3 + x2)));
-            sampleList.push_back(make_pair(vector<int>{v2, v1, v3}, x2 * x1 / (x1 + x3)));
-            sampleList.push_back(make_pair(vector<int>{v2, v3, v1}, x2 * x3 / (x3 + x1)));
-            sampleList.push_back(make_pair(vector<int>{v3, v1, v2}, x3 * x1 / (x1 + x2)));
-            sampleList.push_back(make_pair(vector<int>{v3, v2, v1}, x3 * x2 / (x2 + x1)));
-            
-            uniform_real_distribution<double> curRand(0.0, 1.0);
-            double sample = curRand(rng), sum = 0;
-            
-            for (auto j : sampleList)
-            {
-                sum += j.second;
-                if (sum >= sample)
-                {
-                    list = j.first;
-                    break;
-                }
-            }
+            table.add_order(v1, v2, v3, x1 * x2 / (x2 + x3));
+            table.add_order(v1, v3, v2, x1 * x3 / (x3 + x2));
+            table.add_order(v2, v1, v3, x2 * x1 / (x1 + x3));
+            table.add_order(v2, v3, v1, x2 * x3 / (x3 + x1));
+            table.add_order(v3, v1, v2, x3 * x1 / (x1 + x2));
+            table.add_order(v3, v2, v1, x3 * x2 / (x2 + x1));
         }
+        table.finish_type(hI.size() <= 2);
+    }
+    return table;
+}
+
+// Match online vertices with the compiled table of H'
+const vector<int> &graph::brubach_et_al(workspace &ws, const permutation_table &table)
+{
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_flags &matched = ws.matched;
+    uniform_real_distribution<double> curRand(0.0, 1.0);
+
+    for (int i = from; i < to; i++)
+    {
+        int type = types[i];
+        if (table.size(type) == 0)
+            continue;
+        
+        // Types with a single neighbour have one order, so no randomness is needed
+        const array<int, 3> *list = (table.size(type) == 1) ? &table.get(type, 0) : table.sample(type, curRand(ws.gen));
+        if (list == nullptr)
+            continue;
         
-        for (int j : list)
+        for (int j : *list)
         {
-            if (j != -1 && not matched[j])
+            if (j != -1 && not matched.test(j))
             {
                 res[i] = j;
-                matched[j] = true;
+                matched.set(j);
                 break;
             }
         }
@@ -1,72 +1,85 @@
 // Match with the sampled matching probability of each edge
-vector<int> graph::correlated_sampling(map<pair<int, int>, double> &typeProb)
+const vector<int> &graph::correlated_sampling(workspace &ws, const vector<vector<double>> &edgeProb)
 {
-    vector<int> res(realSize, -1);
-    vector<int> offLine(onSize + offSize, -1);
-    vector<vector<pair<double, int>>> Prob;
-    vector<pair<double, int>> p1;
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_flags &offLine = ws.matched;
+    
+    // Cumulative probabilities of arrival i, padded to 1.1 by not matching, are stored in Prob[start[i], start[i + 1])
+    vector<pair<double, int>> &Prob = ws.prob;
+    vector<int> &start = ws.int1;
     double mass;
-    int jStar = -1;
-    for (int i = 0; i < realSize; i++)
+    int &jStar = ws.pivot;
+    if (from == 0)
     {
-        p1.clear();
-        for (auto j : adj[types[i]])
+        jStar = -1;
+        Prob.clear();
+        start.assign(1, 0);
+        for (int i = 0; i < realSize; i++)
         {
-            mass = typeProb[make_pair(types[i], j)];
-            if (mass > 0.5 + 1e-10)
-                jStar = j;
-            p1.push_back(make_pair(mass, j));
-        }
-        Prob.push_back(p1);
-    }
-
-    for (int i = 0; i < realSize; i++)
-    {
-        double total = 0.0;
-        for (int j = 0; j < (int)Prob[i].size(); j++)
-            total += Prob[i][j].first;
+            double total = 0.0;
+            const vector<int> &nb = adj[types[i]];
+            for (int e = 0; e < (int)nb.size(); e++)
+            {
+                mass = edgeProb[types[i]][e];
+                if (mass > 0.5 + 1e-10)
+                    jStar = nb[e];
+                Prob.push_back(make_pair(mass, nb[e]));
+                total += mass;
+            }
 
-        if (total < 1.1)
-            Prob[i].push_back(make_pair(1.1 - total, -1));
+            if (total < 1.1)
+                Prob.push_back(make_pair(1.1 - total, -1));
 
-        total = 0.0;
-        for (int j = 0; j < (int)Prob[i].size(); j++)
-        {
-            total += Prob[i][j].first;
-            Prob[i][j].first = total;
+            total = 0.0;
+            for (int j = start[i]; j < (int)Prob.size(); j++)
+            {
+                total += Prob[j].first;
+                Prob[j].first = total;
+            }
+            start.push_back(Prob.size());
         }
     }
     uniform_real_distribution<double> rand_sample(0, 1);
     int c1 = -1, c2 = -1;
     double r1, r2;
 
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
-        r1 = rand_sample(rng);
+        const vector<int> &nb = adj[types[i]];
+        const vector<double> &prob = edgeProb[types[i]];
+        r1 = rand_sample(ws.gen);
         r2 = r1 > 0.5 ? r1 - 0.5 : r1 + 0.5;
         pair<double, int> val1 = make_pair(r1, -1);
         pair<double, int> val2 = make_pair(r2, -1);
         // upperbound help return the first element bigger than a input val, if element is a pair, default to compare the first element of the pair
-        c1 = (*upper_bound(Prob[i].begin(),
-                           Prob[i].end(), val1))
+        c1 = (*upper_bound(Prob.begin() + start[i],
+                           Prob.begin() + start[i + 1], val1))
                  .second;
+        c2 = -1;
         if (c1 != jStar || jStar == -1)
         {
-            c2 = (*upper_bound(Prob[i].begin(),
-                               Prob[i].end(), val2))
+            c2 = (*upper_bound(Prob.begin() + start[i],
+                               Prob.begin() + start[i + 1], val2))
                      .second;
         }
         else
         {
-            double massJStar = typeProb[make_pair(types[i], jStar)];
-            vector<pair<double, int>> Prob2;
-            for (auto j : adj[types[i]])
+            // c1 was sampled from neighbors of arrival i, so jStar is one of them
+            double massJStar = 0;
+            for (int e = 0; e < (int)nb.size(); e++)
+                if (nb[e] == jStar)
+                    massJStar = prob[e];
+            vector<pair<double, int>> &Prob2 = ws.prob2;
+            Prob2.clear();
+            for (int e = 0; e < (int)nb.size(); e++)
             {
-                mass = typeProb[make_pair(types[i], j)];
+                mass = prob[e];
                 if (mass < 0.5 - 1e-10)
-                    Prob2.push_back(make_pair(mass / (1.0 - massJStar), j));
+                    Prob2.push_back(make_pair(mass / (1.0 - massJStar), nb[e]));
             }
-            double rr = rand_sample(rng), sum = 0;
+            double rr = rand_sample(ws.gen), sum = 0;
             for (auto item : Prob2)
             {
                 sum += item.first;
@@ -77,16 +90,16 @@ vector<int> graph::correlated_sampling(map<pair<int, int>, double> &typeProb)
                 }
             }
         }
-        if (c1 != -1 && offLine[c1] == -1)
+        if (c1 != -1 && not offLine.test(c1))
         {
             res[i] = c1;
-            offLine[c1] = i;
+            offLine.set(c1);
         }
-        else if (c2 != -1 && offLine[c2] == -1)
+        else if (c2 != -1 && not offLine.test(c2))
         {
             res[i] = c2;
-            offLine[c2] = i;
+            offLine.set(c2);
         }
     }
     return res;
-}
\ No newline at end of file
+}
@@ -41,29 +41,34 @@ pair<vector<int>, vector<int>> graph::feldman_et_al_color()
 
 
 // Match online vertices with advice of blue and red edges
-vector<int> graph::feldman_et_al(vector<int> &blue, vector<int> &red)
+const vector<int> &graph::feldman_et_al(workspace &ws, const vector<int> &blue, const vector<int> &red)
 {
-    vector<int> res(realSize, -1);
-    vector<int> num(onSize, 0);
-    vector<bool> matched(offSize + onSize, false);
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_array<int> &num = ws.count;
+    epoch_flags &matched = ws.matched;
+    if (from == 0)
+        num.reset(onSize, 0);
 
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
         int x = blue[types[i]], y = red[types[i]];
         
-        num[types[i]]++;
+        int k = num.get(types[i]) + 1;
+        num.set(types[i], k);
         
-        if (num[types[i]] == 1 && x != -1 && !matched[x])
+        if (k == 1 && x != -1 && !matched.test(x))
         {
             res[i] = x;
-            matched[x] = true;
+            matched.set(x);
         }
         
-        if (num[types[i]] == 2 && y != -1 && !matched[y])
+        if (k == 2 && y != -1 && !matched.test(y))
         {
             res[i] = y;
-            matched[y] = true;
+            matched.set(y);
         }
     }
     return res;
-}
\ No newline at end of file
+}
@@ -99,24 +99,26 @@ tuple<vector<int>, vector<int>, vector<pair<int, int>>> graph::haeupler_et_al_ad
 }
 
 // Match with advice M1, M2 and fractional matching
-vector<int> graph::haeupler_et_al(const vector<int> &M1, const vector<int> &M2, const vector<pair<int, int>> &M3)
+const vector<int> &graph::haeupler_et_al(workspace &ws, const vector<int> &M1, const vector<int> &M2, const vector<pair<int, int>> &M3)
 {
-    vector<int> res(realSize, -1);
-    vector<bool> matched(onSize + offSize, false);
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_flags &matched = ws.matched;
     
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
-        if (M1[types[i]] != -1 and not matched[M1[types[i]]])
+        if (M1[types[i]] != -1 and not matched.test(M1[types[i]]))
             res[i] = M1[types[i]];
-        else if (M2[types[i]] != -1 and not matched[M2[types[i]]])
+        else if (M2[types[i]] != -1 and not matched.test(M2[types[i]]))
             res[i] = M2[types[i]];
-        else if (M3[types[i]].first != -1 and not matched[M3[types[i]].first])
+        else if (M3[types[i]].first != -1 and not matched.test(M3[types[i]].first))
             res[i] = M3[types[i]].first;
-        else if (M3[types[i]].second != -1 and not matched[M3[types[i]].second])
+        else if (M3[types[i]].second != -1 and not matched.test(M3[types[i]].second))
             res[i] = M3[types[i]].second;
         
         if (res[i] != -1)
-            matched[res[i]] = true;
+            matched.set(res[i]);
 
     }
     return res;
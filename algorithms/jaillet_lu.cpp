@@ -35,21 +35,53 @@ vector<vector<int>> graph::jaillet_lu_list()
     return res;
 }
 
-// Match with list of each online types
-vector<int> graph::jaillet_lu(vector<vector<int>> &jlList)
+// Compile lists into a table holding every order of each list with equal probability
+// Each list has at most three entries, so a type has at most six orders
+permutation_table graph::jaillet_lu_table(const vector<vector<int>> &jlList)
 {
-    vector<int> res(realSize, -1);
-    vector<bool> matched(offSize + onSize, false);
+    permutation_table table;
+    for (int i = 0; i < onSize; i++)
+    {
+        int k = jlList[i].size();
+        if (k)
+        {
+            vector<int> index(k);
+            iota(index.begin(), index.end(), 0);
+            do
+            {
+                int v[3] = {-1, -1, -1};
+                for (int j = 0; j < k; j++)
+                    v[j] = jlList[i][index[j]];
+                table.add_order(v[0], v[1], v[2], 1.0);
+            }
+            while (next_permutation(index.begin(), index.end()));
+        }
+        table.finish_type();
+    }
+    return table;
+}
+
+// Match with list of each online types, probing a uniformly random order of the list
+const vector<int> &graph::jaillet_lu(workspace &ws, const permutation_table &table)
+{
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_flags &matched = ws.matched;
 
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
-        shuffle(jlList[types[i]].begin(), jlList[types[i]].end(), rng);
-        for (int j : jlList[types[i]])
+        int num = table.size(types[i]);
+        if (num == 0)
+            continue;
+        
+        uniform_int_distribution<int> orderDist(0, num - 1);
+        for (int j : table.get(types[i], orderDist(ws.gen)))
         {
-            if (j != -1 && not matched[j])
+            if (j != -1 && not matched.test(j))
             {
                 res[i] = j;
-                matched[j] = true;
+                matched.set(j);
                 break;
             }
         }
@@ -90,4 +122,46 @@ map<pair<int, int>, double> graph::jaillet_lu_non_integral()
             }
 
     return jlProb;
-}
\ No newline at end of file
+}
+
+
+// Flow of non-integral Jaillet and Lu on twin classes, with capacities scaled by multiplicities
+// An online class of k types and an offline class of l vertices share the flow of their k * l edges evenly
+map<pair<int, int>, double> graph::jaillet_lu_non_integral(const twin_classes &twins)
+{
+    const vector<vector<int>> &cAdj = twins.adj;
+    const vector<long long> &mult = twins.mult;
+    int cOn = twins.numOnline, cOff = twins.numOffline;
+
+    // adding jb for each offline class j
+    int s = cOn + 2 * cOff, t = s + 1;
+    long long mul = 1e9, ln = 306852819;
+    basic_flow_graph<long long> g(s, t);
+
+    for (int i = 0; i < cOn; i++)
+        for (int j : cAdj[i])
+        {
+            int jb = j + cOff;
+            long long edges = mult[i] * mult[j];
+            g.add_edge(i, j, mul / 2 * edges);
+            g.add_edge(i, jb, mul * edges);
+            g.add_edge(jb, j, ln * edges);
+        }
+
+    for (int i = 0; i < cOn; i++)
+        g.add_edge(s, i, mul * mult[i]);
+
+    for (int j = cOn; j < cOn + cOff; j++)
+        g.add_edge(j, t, mul * mult[j]);
+    g.max_flow();
+    map<pair<int, int>, double> jlProb;
+    for (int i = 0; i < cOn; i++)
+        for (auto e : g.adj[i])
+            if (e.flow > 0)
+            {
+                int j = (e.v < cOn + cOff) ? e.v : e.v - cOff;
+                jlProb[make_pair(i, j)] += (double)e.flow / mul / (mult[i] * mult[j]);
+            }
+
+    return twins.expand(adj, jlProb);
+}
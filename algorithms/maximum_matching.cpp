@@ -1,8 +1,9 @@
 // Compute offline optimal matching in realization graph
-vector<int> graph::maximum_matching()
+const vector<int> &graph::maximum_matching(workspace &ws)
 {
     int s = realSize + offSize, t = s + 1;
-    flow_graph g(s, t);
+    flow_graph &g = ws.flow;
+    g.reset(s, t);
     
     for (int i = 0; i < realSize; i++)
         for (int j : adj[types[i]])
@@ -16,7 +17,8 @@ vector<int> graph::maximum_matching()
     
     g.max_flow();
     
-    vector<int> res(realSize, -1);
+    ws.start(realSize, onSize + offSize);
+    vector<int> &res = ws.res;
     for(int i = 0; i < realSize; i++)
         for (auto e : g.adj[i])
             if (e.flow > 0)
@@ -1,26 +1,44 @@
 // Match by min-degree algorithm
-vector<int> graph::min_degree()
+// Ties among neighbors of minimum degree are broken by lowest id in the dataset, or uniformly at random if randomTie is set
+const vector<int> &graph::min_degree(workspace &ws, bool randomTie)
 {
-    vector<int> res(realSize, -1);
-    vector<int> degree(onSize + offSize, 0);
-    vector<bool> matched(onSize + offSize, 0);
-    vector<pair<int, int>> unmatchedNeighbors;
-    int index;
-    for (int i = 0; i < realSize; i++)
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_array<int> &degree = ws.count;
+    epoch_flags &matched = ws.matched;
+    if (from == 0)
+        degree.reset(onSize + offSize, 0);
+    for (int i = from; i < to; i++)
     {
-        unmatchedNeighbors.clear();
-        for (auto j : adj[types[i]])
-            if (not matched[j])
-                degree[j]++, unmatchedNeighbors.push_back(make_pair(degree[j], j));
+        int index = -1, numTie = 0, minDegree = 0;
+        for (int j : adj[types[i]])
+            if (not matched.test(j))
+            {
+                int d = degree.get(j) + 1;
+                degree.set(j, d);
+                if (index == -1 || d < minDegree)
+                    index = j, numTie = 1, minDegree = d;
+                else if (d == minDegree)
+                {
+                    // Reservoir sampling keeps each tied neighbor with equal probability
+                    numTie++;
+                    if (randomTie)
+                    {
+                        uniform_int_distribution<int> tieDist(0, numTie - 1);
+                        if (tieDist(ws.gen) == 0)
+                            index = j;
+                    }
+                    else if (id(j) < id(index))
+                        index = j;
+                }
+            }
 
-        if (unmatchedNeighbors.size())
+        if (index != -1)
         {
-            // By default the sort function sorts the vector elements on basis of first element of pairs.
-            sort(unmatchedNeighbors.begin(), unmatchedNeighbors.end());
-            index = unmatchedNeighbors[0].second;
-            matched[index] = true;
+            matched.set(index);
             res[i] = index;
         }
     }
     return res;
-}
\ No newline at end of file
+}
@@ -1,26 +1,47 @@
 // Match with offline mass and weight x_{ij} for each edge
-vector<int> graph::poisson_ocs(const vector<double> &offMass, map<pair<int, int>, double> &typeProb)
+// Weight exp(t * offMass[j]) at time t is interpolated from a table with steps + 1 entries per offline vertex,
+// or computed exactly if steps is 0
+const vector<int> &graph::poisson_ocs(workspace &ws, const vector<double> &offMass, const vector<vector<double>> &edgeProb, const vector<double> &weight, int steps)
 {
-    vector<int> res(realSize, -1);
-    vector<bool> matched(onSize + offSize, false);
-     for (int i = 0; i < realSize; i++)
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_flags &matched = ws.matched;
+    vector<pair<int, double>> &validMass = ws.validMass;
+    for (int i = from; i < to; i++)
     {
-        double totalMass = 0.0, mass;
-        vector<pair<int, double>> validMass;
+        double totalMass = 0.0, mass, t = 1.0 * i / realSize;
         int index = -1;
-        for (int j : adj[types[i]])
+        
+        // Position of time t in the table
+        double pos = t * steps;
+        int k = min((int)pos, steps - 1);
+        double frac = pos - k;
+        
+        validMass.clear();
+        const vector<int> &nb = adj[types[i]];
+        const vector<double> &prob = edgeProb[types[i]];
+        for (int e = 0; e < (int)nb.size(); e++)
         {
-            mass = exp((1.0 * i / types.size()) * offMass[j]) * typeProb[make_pair(types[i], j)];
-            if (not matched[j] and mass > 0.0)
+            int j = nb[e];
+            if (matched.test(j) or prob[e] <= 0.0)
+                continue;
+            
+            if (steps == 0)
+                mass = exp(t * offMass[j]) * prob[e];
+            else
             {
-                totalMass += mass;
-                validMass.push_back(make_pair(j, mass));
+                const double *w = &weight[(j - onSize) * (steps + 1) + k];
+                mass = (w[0] + frac * (w[1] - w[0])) * prob[e];
             }
+            
+            totalMass += mass;
+            validMass.push_back(make_pair(j, mass));
         }
         if (validMass.size())
         {
             std::uniform_real_distribution<double> distr(0, totalMass);
-            double rr = distr(rng), sum = 0;
+            double rr = distr(ws.gen), sum = 0;
             for (auto item : validMass)
             {
                 sum += item.second;
@@ -33,13 +54,28 @@ vector<int> graph::poisson_ocs(const vector<double> &offMass, map<pair<int, int>
             if (index != -1)
             {
                 res[i] = index;
-                matched[index] = true;
+                matched.set(index);
             }
         }
     }
     return res;
 }
 
+// Tabulate exp(k / steps * offMass[j]) for k = 0, ..., steps and each offline vertex j
+// Linear interpolation in between has relative error at most (offMass[j] / steps)^2 / 8
+vector<double> graph::poisson_weight_table(const vector<double> &offMass, int steps)
+{
+    vector<double> weight;
+    if (steps == 0)
+        return weight;
+    
+    weight.resize(offSize * (steps + 1));
+    for (int j = onSize; j < onSize + offSize; j++)
+        for (int k = 0; k <= steps; k++)
+            weight[(j - onSize) * (steps + 1) + k] = exp(1.0 * k / steps * offMass[j]);
+    return weight;
+}
+
 // Compute mass of each offline vertex
 vector<double> graph::poisson_offline_mass(map<pair<int, int>, double> &typeProb)
 {
@@ -50,4 +86,17 @@ vector<double> graph::poisson_offline_mass(map<pair<int, int>, double> &typeProb
         for (int j : adj[i])
             offMass[j] += typeProb[make_pair(i, j)];
     return offMass;
-}
\ No newline at end of file
+}
+
+// Store the probability of each edge in the same layout as the adjacency list, for online types and offline vertices
+vector<vector<double>> graph::edge_prob(const map<pair<int, int>, double> &typeProb)
+{
+    vector<vector<double>> edgeProb(onSize + offSize);
+    for (int i = 0; i < onSize + offSize; i++)
+        for (int j : adj[i])
+        {
+            auto iter = (i < onSize) ? typeProb.find(make_pair(i, j)) : typeProb.find(make_pair(j, i));
+            edgeProb[i].push_back(iter == typeProb.end() ? 0.0 : iter->second);
+        }
+    return edgeProb;
+}
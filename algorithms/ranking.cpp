@@ -1,25 +1,51 @@
 // Match by RANKING algorithm
-vector<int> graph::ranking()
+// Neighbors of each type are bucketed by decreasing rank once per run,
+// so each type keeps a cursor that only moves forward past matched offline vertices
+const vector<int> &graph::ranking(workspace &ws)
 {
-    vector<int> rank(onSize + offSize, 0);
-    vector<int> res(realSize, -1);
-    vector<int> matched(onSize + offSize, -1);
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_flags &matched = ws.matched;
 
-    iota(rank.begin(), rank.end(), 0);
-    shuffle(rank.begin(), rank.end(), rng);
+    // Offline vertices in decreasing order of a uniformly random rank
+    // Neighbors of type i in decreasing order of rank are stored in sorted[start[i], start[i + 1])
+    vector<int> &byRank = ws.int1;
+    vector<int> &start = ws.int2;
+    vector<int> &sorted = ws.int3;
+    vector<int> &cursor = ws.int4;
+    if (from == 0)
+    {
+        byRank.resize(offSize);
+        iota(byRank.begin(), byRank.end(), onSize);
+        shuffle(byRank.begin(), byRank.end(), ws.gen);
+
+        start.assign(onSize + 1, 0);
+        for (int i = 0; i < onSize; i++)
+            start[i + 1] = start[i] + adj[i].size();
+
+        sorted.resize(start[onSize]);
+        cursor.assign(start.begin(), start.end() - 1);
+        for (int j : byRank)
+            for (int i : adj[j])
+                sorted[cursor[i]++] = j;
+        copy(start.begin(), start.end() - 1, cursor.begin());
+    }
 
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
         int match = -1;
         
-        for (int j : adj[types[i]])
-            if (matched[j] == -1)
-                if (match == -1 || rank[j] > rank[match])
-                    match = j;
+        // Matched offline vertices never become unmatched, so skipped entries are never revisited
+        int &c = cursor[types[i]];
+        while (c < start[types[i] + 1] && matched.test(sorted[c]))
+            c++;
+        if (c < start[types[i] + 1])
+            match = sorted[c];
 
         res[i] = match;
         if (match != -1)
-            matched[match] = i;
+            matched.set(match);
         
     }
     return res;
@@ -1,5 +1,5 @@
 // Match by Regularized Greedy
-vector<int> graph::regularized_greedy(map<pair<int, int>, double> &typeProb)
+const vector<int> &graph::regularized_greedy(workspace &ws, const vector<vector<double>> &edgeProb)
 {
     double theta = 0.4253;
     auto alpha = [&theta](double t)
@@ -14,33 +14,41 @@ vector<int> graph::regularized_greedy(map<pair<int, int>, double> &typeProb)
     {
         return min(x / theta, 1.0);
     };
-    vector<double> offlineMass(onSize + offSize, 0);
-    vector<double> onlineMass(onSize + offSize, 0);
-    for (int i = 0; i < onSize; i++)
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_flags &matched = ws.matched;
+    vector<double> &offlineMass = ws.real1;
+    vector<double> &onlineMass = ws.real2;
+    if (from == 0)
     {
-        for (int j : adj[i])
+        offlineMass.assign(onSize + offSize, 0);
+        onlineMass.assign(onSize + offSize, 0);
+        for (int i = 0; i < onSize; i++)
         {
-            double mass = typeProb[make_pair(i, j)];
-            offlineMass[j] += mass;
-            onlineMass[i] += mass;
+            for (int e = 0; e < (int)adj[i].size(); e++)
+            {
+                double mass = edgeProb[i][e];
+                offlineMass[adj[i][e]] += mass;
+                onlineMass[i] += mass;
+            }
         }
     }
-    vector<int> res(realSize, -1);
-    vector<bool> matched(onSize + offSize, false);
     
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
         double minVal = 1e10, val;
         int index = -1;
         for (int j : adj[types[i]])
         {
-            if (not matched[j])
+            if (not matched.test(j))
             {
                 double t = 1.0 * i / realSize;
                 val = alpha(t) * offlineMass[j];
-                for (int onlineTypeNeighbor : adj[j])
+                for (int e = 0; e < (int)adj[j].size(); e++)
                 {
-                    val += beta(t) * (p(onlineMass[onlineTypeNeighbor]) - p(onlineMass[onlineTypeNeighbor] - typeProb[make_pair(onlineTypeNeighbor, j)]));
+                    int onlineTypeNeighbor = adj[j][e];
+                    val += beta(t) * (p(onlineMass[onlineTypeNeighbor]) - p(onlineMass[onlineTypeNeighbor] - edgeProb[j][e]));
                 }
                 if (minVal > val)
                 {
@@ -52,10 +60,10 @@ vector<int> graph::regularized_greedy(map<pair<int, int>, double> &typeProb)
         if (index != -1)
         {
             res[i] = index;
-            matched[index] = true;
+            matched.set(index);
             offlineMass[index] = 0;
-            for (int onlineTypeNeighbor: adj[index])
-                onlineMass[onlineTypeNeighbor] -= typeProb[make_pair(onlineTypeNeighbor, index)];
+            for (int e = 0; e < (int)adj[index].size(); e++)
+                onlineMass[adj[index][e]] -= edgeProb[index][e];
         }
     }
     return res;
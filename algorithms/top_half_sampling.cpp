@@ -1,18 +1,24 @@
 // Match by top-half sampling
-vector<int> graph::top_half_sampling(map<pair<int, int>, double> &typeProb)
+const vector<int> &graph::top_half_sampling(workspace &ws, const vector<vector<double>> &edgeProb)
 {
-    vector<int> res(realSize, -1);
-    vector<bool> matched(onSize + offSize, false);
+    int from = ws.begin(realSize, onSize + offSize);
+    int to = ws.end(realSize);
+    vector<int> &res = ws.res;
+    epoch_flags &matched = ws.matched;
+    vector<pair<int, double>> &validMass = ws.validMass;
     // ith means ith arrival online vertex while i means type  i
-    for (int i = 0; i < realSize; i++)
+    for (int i = from; i < to; i++)
     {
         double totalMass = 0.0,  mass;
-        vector<pair<int, double>> validMass;
+        validMass.clear();
         int index = -1;
-        for (int j : adj[types[i]])
+        const vector<int> &nb = adj[types[i]];
+        const vector<double> &prob = edgeProb[types[i]];
+        for (int e = 0; e < (int)nb.size(); e++)
         {
-            mass = typeProb[make_pair(types[i], j)];
-            if (not matched[j] and mass > 0.0)
+            int j = nb[e];
+            mass = prob[e];
+            if (not matched.test(j) and mass > 0.0)
             {
                 totalMass += mass;
                 validMass.push_back(make_pair(j, mass));
@@ -21,7 +27,7 @@ vector<int> graph::top_half_sampling(map<pair<int, int>, double> &typeProb)
         if (validMass.size())
         {
             std::uniform_real_distribution<double> distr(0, 1.0 / 2);
-            double rr = distr(rng), sum = 0;
+            double rr = distr(ws.gen), sum = 0;
             for (auto item : validMass)
             {
                 sum += item.second;
@@ -34,7 +40,7 @@ vector<int> graph::top_half_sampling(map<pair<int, int>, double> &typeProb)
             if (index != -1)
             {
                 res[i] = index;
-                matched[index] = true;
+                matched.set(index);
             }
         }
     }
@@ -0,0 +1,250 @@
+// Micro-benchmarks of algorithms and helpers of the library
+// Usage: benchmark [--graph path name] [--synthetic model n m edges] [--large] [--warmup w] [--reps r] [--filter text] [--csv path]
+// Without graphs, the benchmarks run on the small real-world datasets and three synthetic graphs
+
+#include "stochastic_matching_library.h"
+
+
+// A benchmark repeats its body inner times per timed repetition, and reports time per iteration
+struct bench_case
+{
+    string name;
+    function<void()> body;
+    int inner;
+};
+
+// Options of the benchmark run
+struct bench_options
+{
+    vector<pair<string, string>> graphs;
+    vector<synthetic_spec> synthetic;
+    int warmup, reps;
+    string filter, csv;
+
+    bench_options()
+    {
+        graphs = {};
+        synthetic = {};
+        warmup = 2;
+        reps = 15;
+        filter = "";
+        csv = "";
+    }
+};
+
+// Return the q-th quantile of sorted values
+double quantile(const vector<double> &sorted, double q)
+{
+    double pos = q * (sorted.size() - 1);
+    int lo = (int)pos;
+    int hi = min(lo + 1, (int)sorted.size() - 1);
+    return sorted[lo] + (pos - lo) * (sorted[hi] - sorted[lo]);
+}
+
+// Run a benchmark with warmup, and print median and percentiles of time per iteration in microseconds
+void run_case(const bench_case &c, const string &graphName, const bench_options &opt, ofstream &csv)
+{
+    if (!opt.filter.empty() && c.name.find(opt.filter) == string::npos)
+        return;
+
+    for (int w = 0; w < opt.warmup; w++)
+        for (int k = 0; k < c.inner; k++)
+            c.body();
+
+    vector<double> times;
+    for (int r = 0; r < opt.reps; r++)
+    {
+        double start = wall_time();
+        for (int k = 0; k < c.inner; k++)
+            c.body();
+        times.push_back((wall_time() - start) / c.inner * 1e6);
+    }
+    sort(times.begin(), times.end());
+
+    cout << left << setw(16) << graphName << setw(32) << c.name << right << fixed << setprecision(3)
+         << setw(14) << quantile(times, 0.5) << setw(14) << quantile(times, 0.1) << setw(14) << quantile(times, 0.9)
+         << setw(14) << times[0] << endl;
+    if (csv.is_open())
+        csv << graphName << "," << c.name << "," << opt.reps << "," << c.inner << "," << quantile(times, 0.5) << ","
+            << quantile(times, 0.1) << "," << quantile(times, 0.9) << "," << times[0] << endl;
+}
+
+// Run all benchmarks on one type graph
+void bench_graph(graph &g, const string &graphName, const bench_options &opt, ofstream &csv)
+{
+    int n = g.online_size();
+    vector<bench_case> cases;
+
+    // Inputs of online algorithms, computed once, with exact Poisson OCS weights as in the main program
+    preprocessing pre(g, 100, false, 0);
+    pre.prepare((1u << numStage) - 1 - stage_bit(stageNaturalProb));
+
+    // Online algorithms run on one fixed realization, so repetitions do the same work
+    // Their times include restoring the realization, which costs about as much as realize
+    g.realize(n);
+    vector<int> fixedTypes = g.get_types();
+    workspace ws;
+
+    cases.push_back({"realize", [&]() { g.realize(n); }, 10});
+    cases.push_back({"maximum_matching", [&]() { g.realize(fixedTypes); g.maximum_matching(ws); }, 1});
+
+    cases.push_back({"optimal_matching_prob(100)", [&]() { g.optimal_matching_prob(100, n); }, 1});
+    cases.push_back({"edge_prob", [&]() { g.edge_prob(pre.typeProb); }, 1});
+    cases.push_back({"poisson_offline_mass", [&]() { g.poisson_offline_mass(pre.typeProb); }, 1});
+    cases.push_back({"poisson_weight_table(64)", [&]() { g.poisson_weight_table(pre.offMass, 64); }, 1});
+    vector<double> poissonTable = g.poisson_weight_table(pre.offMass, 64);
+    cases.push_back({"feldman_et_al_color", [&]() { g.feldman_et_al_color(); }, 1});
+    cases.push_back({"bahmani_kapralov_color", [&]() { g.bahmani_kapralov_color(); }, 1});
+    cases.push_back({"jaillet_lu_list", [&]() { g.jaillet_lu_list(); }, 1});
+    vector<vector<int>> jlList = g.jaillet_lu_list();
+    cases.push_back({"jaillet_lu_table", [&]() { g.jaillet_lu_table(jlList); }, 1});
+    cases.push_back({"jaillet_lu_non_integral", [&]() { g.jaillet_lu_non_integral(); }, 1});
+    cases.push_back({"brubach_et_al_lp", [&]() { g.brubach_et_al_lp(); }, 1});
+    cases.push_back({"brubach_et_al_h", [&]() { g.brubach_et_al_h(pre.brubachLp); }, 1});
+    vector<vector<pair<int, double>>> brubachH = g.brubach_et_al_h(pre.brubachLp);
+    cases.push_back({"brubach_et_al_table", [&]() { g.brubach_et_al_table(brubachH); }, 1});
+    cases.push_back({"haeupler_et_al_advice", [&]() { g.haeupler_et_al_advice(pre.brubachLp); }, 1});
+
+    // Online algorithms, as in the registry of the main program
+    vector<pair<string, function<void()>>> online = {
+        {"sampling_without_replacement", [&]() { g.sampling_without_replacement(ws, pre.edgeProb); }},
+        {"regularized_greedy", [&]() { g.regularized_greedy(ws, pre.edgeProb); }},
+        {"poisson_ocs", [&]() { g.poisson_ocs(ws, pre.offMass, pre.edgeProb, pre.poissonWeight, pre.poissonSteps); }},
+        {"poisson_ocs(64 steps)", [&]() { g.poisson_ocs(ws, pre.offMass, pre.edgeProb, poissonTable, 64); }},
+        {"top_half_sampling", [&]() { g.top_half_sampling(ws, pre.edgeProb); }},
+        {"correlated_sampling", [&]() { g.correlated_sampling(ws, pre.edgeProb); }},
+        {"ranking", [&]() { g.ranking(ws); }},
+        {"balance_swor", [&]() { g.balance_swor(ws); }},
+        {"balance_ocs", [&]() { g.balance_ocs(ws); }},
+        {"min_degree", [&]() { g.min_degree(ws); }},
+        {"manshadi_et_al", [&]() { g.manshadi_et_al(ws, pre.typeEdgeProb); }},
+        {"brubach_et_al", [&]() { g.brubach_et_al(ws, pre.brubachTable); }},
+        {"jaillet_lu", [&]() { g.jaillet_lu(ws, pre.jlTable); }},
+        {"haeupler_et_al", [&]() { g.haeupler_et_al(ws, pre.heauplerM1, pre.heauplerM2, pre.heauplerM3); }},
+        {"bahmani_kapralov", [&]() { g.bahmani_kapralov(ws, pre.blueB, pre.redB); }},
+        {"feldman_et_al", [&]() { g.feldman_et_al(ws, pre.blueF, pre.redF); }}};
+    for (auto &alg : online)
+    {
+        auto run = alg.second;
+        cases.push_back({alg.first, [&g, &fixedTypes, run]() { g.realize(fixedTypes); run(); }, 1});
+    }
+
+    // Helpers: water filling over a typical neighborhood, maximum flow of the type graph, cycle break, natural LP
+    vector<double> level(32);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    for (auto &l : level)
+        l = unit(rng);
+    cases.push_back({"fill_water(32)", [&]() { vector<double> copy = level; fill_water(copy, 1); }, 100});
+
+    vector<vector<int>> adj = g.get_adj();
+    int total = adj.size();
+    cases.push_back({"flow_graph::max_flow", [&]()
+    {
+        flow_graph flow(total, total + 1);
+        for (int i = 0; i < n; i++)
+        {
+            flow.add_edge(total, i, 1);
+            for (int j : adj[i])
+                flow.add_edge(i, j, 1);
+        }
+        for (int j = n; j < total; j++)
+            flow.add_edge(j, total + 1, 1);
+        flow.max_flow();
+    }, 1});
+
+    cases.push_back({"cycle_break_graph rounding", [&]()
+    {
+        cycle_break_graph gCycle(n, total);
+        for (auto &e : pre.brubachLp)
+            if (e.second > 1e-10)
+                gCycle.add_edge(e.first.first, e.first.second, e.second * 3);
+        gCycle.gandhi_et_al_rounding();
+        gCycle.frac_to_int();
+        gCycle.cycle_break();
+    }, 1});
+
+    // Natural LP is extremely slow, so only benchmarked on tiny graphs
+    if (n <= 50)
+        cases.push_back({"natural_lp", [&]() { natural_lp(adj, n).solve_lp(); }, 1});
+
+    for (auto &c : cases)
+        run_case(c, graphName, opt, csv);
+}
+
+int main(int argc, char **argv)
+{
+    bench_options opt;
+    bool large = false;
+    synthetic_spec spec;
+    for (int i = 1; i < argc; i++)
+    {
+        string key = argv[i];
+        if (key == "--graph" && i + 2 < argc)
+            opt.graphs.push_back(make_pair(argv[i + 1], argv[i + 2])), i += 2;
+        else if (key == "--synthetic" && i + 4 < argc && spec.parse(vector<string>(argv + i + 1, argv + i + 5)))
+            opt.synthetic.push_back(spec), i += 4;
+        else if (key == "--large")
+            large = true;
+        else if (key == "--warmup" && i + 1 < argc)
+            opt.warmup = stoi(argv[++i]);
+        else if (key == "--reps" && i + 1 < argc)
+            opt.reps = max(1, stoi(argv[++i]));
+        else if (key == "--filter" && i + 1 < argc)
+            opt.filter = argv[++i];
+        else if (key == "--csv" && i + 1 < argc)
+            opt.csv = argv[++i];
+        else
+        {
+            cerr << "Invalid argument: " << key << endl;
+            return 1;
+        }
+    }
+
+    if (opt.graphs.empty() && opt.synthetic.empty())
+    {
+        opt.graphs = {
+            make_pair("real_world_small/soc-firm-hi-tech/soc-firm-hi-tech.txt", "hi-tech"),
+            make_pair("real_world_small/soc-physicians/soc-physicians.edges", "physicians"),
+            make_pair("real_world_small/gent113/gent113.mtx", "gent113"),
+            make_pair("real_world_small/lp_blend/lp_blend.mtx", "lp_blend")};
+        for (auto values : vector<vector<string>>{{"er", "1000", "1000", "5000"}, {"er", "10000", "10000", "50000"}, {"chung_lu", "10000", "10000", "50000"}})
+        {
+            spec.parse(values);
+            opt.synthetic.push_back(spec);
+        }
+    }
+    if (large)
+        opt.graphs.insert(opt.graphs.end(), {
+            make_pair("real_world/socfb-Caltech36/socfb-Caltech36.txt", "Caltech36"),
+            make_pair("real_world/socfb-Reed98/socfb-Reed98.txt", "Reed98"),
+            make_pair("real_world/bio-CE-GN/bio-CE-GN.txt", "CE-GN"),
+            make_pair("real_world/bio-CE-PG/bio-CE-PG.txt", "CE-PG"),
+            make_pair("real_world/econ-beause/econ-beause.txt", "beause"),
+            make_pair("real_world/econ-mbeaflw/econ-mbeaflw.txt", "mbeaflw")});
+
+    // Fixed seed, so that runs benchmark the same graphs and realizations
+    rng.seed(2023);
+
+    ofstream csv;
+    if (!opt.csv.empty())
+    {
+        csv.open(opt.csv);
+        csv << "graph,benchmark,reps,inner,median_us,p10_us,p90_us,min_us" << endl;
+    }
+
+    cout << left << setw(16) << "Graph" << setw(32) << "Benchmark" << right << setw(14) << "median(us)"
+         << setw(14) << "p10(us)" << setw(14) << "p90(us)" << setw(14) << "min(us)" << endl;
+
+    for (auto &item : opt.graphs)
+    {
+        graph g = generate_from_file(item.first, true, 0);
+        bench_graph(g, item.second, opt, csv);
+    }
+    for (auto &s : opt.synthetic)
+    {
+        s.seed = rng();
+        graph g = generate_synthetic(s);
+        bench_graph(g, string(syntheticName[s.model]) + to_string(s.n), opt, csv);
+    }
+    return 0;
+}
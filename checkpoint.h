@@ -0,0 +1,121 @@
+// Checkpoints of long experiments, so that a run interrupted by a crash or preemption resumes where it stopped
+// A checkpoint is a text file of values separated by spaces, written by put and read back in the same order by get
+// Doubles are written with max_digits10 digits, and random generators by their full state,
+// so a resumed run continues from exactly the same state and gives the same results
+
+
+void put(ostream &out, double x)
+{
+    out << setprecision(numeric_limits<double>::max_digits10) << x << ' ';
+}
+
+void put(ostream &out, long long x)
+{
+    out << x << ' ';
+}
+
+void put(ostream &out, int x)
+{
+    out << x << ' ';
+}
+
+void put(ostream &out, bool x)
+{
+    out << (x ? 1 : 0) << ' ';
+}
+
+// Strings are written as tokens, so they must not contain spaces
+void put(ostream &out, const string &s)
+{
+    out << (s.empty() ? "-" : s) << ' ';
+}
+
+void put(ostream &out, const mt19937 &gen)
+{
+    out << gen << ' ';
+}
+
+template <class A, class B>
+void put(ostream &out, const pair<A, B> &x)
+{
+    put(out, x.first);
+    put(out, x.second);
+}
+
+template <class T>
+void put(ostream &out, const vector<T> &v)
+{
+    put(out, (long long)v.size());
+    for (auto &x : v)
+        put(out, x);
+}
+
+
+// Infinities and NaN (e.g. the minimum of no values) are read by strtod
+void get(istream &in, double &x)
+{
+    string token;
+    in >> token;
+    x = strtod(token.c_str(), nullptr);
+}
+
+void get(istream &in, long long &x)
+{
+    in >> x;
+}
+
+void get(istream &in, int &x)
+{
+    in >> x;
+}
+
+void get(istream &in, bool &x)
+{
+    int v;
+    in >> v;
+    x = (v != 0);
+}
+
+void get(istream &in, string &s)
+{
+    in >> s;
+    if (s == "-")
+        s = "";
+}
+
+void get(istream &in, mt19937 &gen)
+{
+    in >> gen;
+}
+
+template <class A, class B>
+void get(istream &in, pair<A, B> &x)
+{
+    get(in, x.first);
+    get(in, x.second);
+}
+
+template <class T>
+void get(istream &in, vector<T> &v)
+{
+    long long size;
+    get(in, size);
+    v.resize(size);
+    for (auto &x : v)
+        get(in, x);
+}
+
+
+// Write a checkpoint by save into a temporary file renamed to path, so an interrupted write keeps the previous one
+void write_checkpoint_file(const string &path, function<void(ostream &)> save)
+{
+    string temp = path + ".tmp";
+    ofstream out(temp);
+    save(out);
+    out.close();
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+    if (!out || rename(temp.c_str(), path.c_str()) != 0)
+        cerr << "Cannot write checkpoint " << path << endl;
+}
@@ -0,0 +1,287 @@
+// Configuration of an experiment, read from a config file and from command line
+// Each line of a config file sets one option, and "--option values" in command line does the same:
+//   dataset <path> <name>       add a dataset, in the order of output columns
+//   synthetic <name> <model> <n> <m> <edges> [param]
+//                               add a synthetic dataset, see synthetic_graph.h
+//   mode <stochastic|non_stochastic|generate>
+//                               generate writes synthetic datasets as <output>/<name>.txt instead of running
+//   numGraph <n>                type graphs generated from each dataset
+//   numSample <n>               realization graphs sampled from each type graph
+//   seed <n>                    seed of rng, random if not set
+//   algorithms <name> ...       algorithms to run, in the order of output rows, default all but MinDegreeRandomTie
+//                               (MinDegree breaking ties uniformly at random instead of by lowest id)
+//   useNatural <0|1>            use natural LP solution instead of Monte-Carlo simulation
+//   poissonSteps <n>            time steps of interpolated Poisson OCS weights, default 0 for exact weights
+//   targetHalfWidth <w>         stop runs of an algorithm once the 95% confidence interval of its ratio to OPT
+//                               has half-width at most w, 0 for always numSample runs
+//   blockSize <n>               samples between checks of confidence intervals
+//   sampling <iid|antithetic|lhs>
+//                               realizations i.i.d., in antithetic pairs, or in Latin hypercube blocks
+//   strata <n>                  realizations in a Latin hypercube block
+//   controlVariate <0|1>        correct ratios to OPT by the number of distinct online types as a control variate
+//   perfCounters <0|1>          count hardware events of algorithms and stages by Linux perf_event_open
+//   memoryBudget <MB>           heap memory of a preprocessing stage above which the experiment is aborted, 0 for none
+//   checkpoint <path>           checkpoint file, from which the experiment resumes if it exists, removed at the end
+//   checkpointInterval <s>      seconds between checkpoints, written at the end of type graphs and blocks of samples
+//   components <0|1>            preprocess connected components of type graphs separately, default 1
+//   twins <0|1>                 solve the LP of Brubach et al. and the flow of non-integral Jaillet and Lu on twin classes
+//   reorder <none|degree|bfs>   relabel vertices of type graphs for locality, see vertex_order.h
+//   threads <n>                 threads computing preprocessing and synthetic graphs, 0 for all hardware threads
+//   workers <n>                 run the experiment in n worker processes, each doing one shard, and merge their results
+//   shard <k> <n>               only do shard k of n (from 0), saving its partial results as <output>/resShard<k>.txt
+//   merge <n>                   merge partial results of n shards into result files, see shard.h
+//   output <directory>          directory of result files
+//   repetitions <n>             repetitions of the experiment, each giving one value of every metric for baselines
+//   saveBaseline <path>         save throughput, latency, time, memory and ratio to OPT metrics as a JSON baseline
+//   compareBaseline <path>      compare metrics with a baseline into resRegression.csv, exit with code 2 on regressions
+//   regressionThreshold <r>     relative change of a performance metric that is a regression, default 0.05
+//   qualityThreshold <w>        absolute change of a ratio to OPT that is a regression, default 0.005
+// Empty lines and lines starting with # are ignored
+
+
+struct experiment_config{
+
+    vector<pair<string, string>> datasets;
+    bool stochastic, generate;
+    int numGraph, numSample;
+    bool hasSeed;
+    unsigned seed;
+    vector<string> algorithms;
+    bool useNatural;
+    int poissonSteps;
+    double targetHalfWidth;
+    int blockSize;
+    sampling_mode sampling;
+    int strata;
+    bool controlVariate;
+    bool perfCounters;
+    double memoryBudget;
+    string checkpoint;
+    double checkpointInterval;
+    bool components, twins;
+    reorder_mode reorder;
+    int threads;
+    int workers, shardIndex, shardCount, mergeCount;
+    string output;
+    int repetitions;
+    string saveBaseline, compareBaseline;
+    double regressionThreshold, qualityThreshold;
+
+    // Defaults are the experiments on real-world datasets in online stochastic matching
+    experiment_config()
+    {
+        datasets = {};
+        stochastic = true;
+        generate = false;
+        numGraph = -1;
+        numSample = -1;
+        hasSeed = false;
+        seed = 0;
+        algorithms = {};
+        useNatural = false;
+        poissonSteps = 0;
+        targetHalfWidth = 0;
+        blockSize = 1024;
+        sampling = samplingIid;
+        strata = 16;
+        controlVariate = false;
+        perfCounters = false;
+        memoryBudget = 0;
+        checkpoint = "";
+        checkpointInterval = 300;
+        components = true;
+        twins = false;
+        reorder = reorderNone;
+        threads = 0;
+        workers = 0;
+        shardIndex = 0;
+        shardCount = 0;
+        mergeCount = 0;
+        output = "real_world_result";
+        repetitions = 1;
+        saveBaseline = "";
+        compareBaseline = "";
+        regressionThreshold = 0.05;
+        qualityThreshold = 0.005;
+    }
+
+    // Set option key to values, and exit on an invalid option or a malformed number
+    void set(const string &key, const vector<string> &values)
+    {
+        bool valid = true;
+        try
+        {
+            if (key == "dataset" && values.size() == 2)
+                datasets.push_back(make_pair(values[0], values[1]));
+            else if (key == "synthetic" && !values.empty())
+            {
+                synthetic_spec spec;
+                valid = spec.parse(vector<string>(values.begin() + 1, values.end()));
+                if (valid)
+                    datasets.push_back(make_pair(spec.path(), values[0]));
+            }
+            else if (key == "mode" && values.size() == 1 && (values[0] == "stochastic" || values[0] == "non_stochastic" || values[0] == "generate"))
+                stochastic = (values[0] != "non_stochastic"), generate = (values[0] == "generate");
+            else if (key == "numGraph" && values.size() == 1)
+                numGraph = stoi(values[0]);
+            else if (key == "numSample" && values.size() == 1)
+                numSample = stoi(values[0]);
+            else if (key == "seed" && values.size() == 1)
+                hasSeed = true, seed = stoul(values[0]);
+            else if (key == "algorithms" && !values.empty())
+                algorithms = values;
+            else if (key == "useNatural" && values.size() == 1)
+                useNatural = (stoi(values[0]) != 0);
+            else if (key == "poissonSteps" && values.size() == 1)
+                poissonSteps = stoi(values[0]);
+            else if (key == "targetHalfWidth" && values.size() == 1)
+                targetHalfWidth = stod(values[0]);
+            else if (key == "blockSize" && values.size() == 1 && stoi(values[0]) > 0)
+                blockSize = stoi(values[0]);
+            else if (key == "sampling" && values.size() == 1 && values[0] == "iid")
+                sampling = samplingIid;
+            else if (key == "sampling" && values.size() == 1 && values[0] == "antithetic")
+                sampling = samplingAntithetic;
+            else if (key == "sampling" && values.size() == 1 && values[0] == "lhs")
+                sampling = samplingLhs;
+            else if (key == "strata" && values.size() == 1 && stoi(values[0]) > 0)
+                strata = stoi(values[0]);
+            else if (key == "controlVariate" && values.size() == 1)
+                controlVariate = (stoi(values[0]) != 0);
+            else if (key == "perfCounters" && values.size() == 1)
+                perfCounters = (stoi(values[0]) != 0);
+            else if (key == "memoryBudget" && values.size() == 1 && stod(values[0]) >= 0)
+                memoryBudget = stod(values[0]);
+            else if (key == "checkpoint" && values.size() == 1)
+                checkpoint = values[0];
+            else if (key == "checkpointInterval" && values.size() == 1 && stod(values[0]) >= 0)
+                checkpointInterval = stod(values[0]);
+            else if (key == "components" && values.size() == 1)
+                components = (stoi(values[0]) != 0);
+            else if (key == "twins" && values.size() == 1)
+                twins = (stoi(values[0]) != 0);
+            else if (key == "reorder" && values.size() == 1 && values[0] == "none")
+                reorder = reorderNone;
+            else if (key == "reorder" && values.size() == 1 && values[0] == "degree")
+                reorder = reorderDegree;
+            else if (key == "reorder" && values.size() == 1 && values[0] == "bfs")
+                reorder = reorderBfs;
+            else if (key == "threads" && values.size() == 1)
+                threads = stoi(values[0]);
+            else if (key == "workers" && values.size() == 1 && stoi(values[0]) > 0)
+                workers = stoi(values[0]);
+            else if (key == "shard" && values.size() == 2 && stoi(values[0]) >= 0 && stoi(values[0]) < stoi(values[1]))
+                shardIndex = stoi(values[0]), shardCount = stoi(values[1]);
+            else if (key == "merge" && values.size() == 1 && stoi(values[0]) > 0)
+                mergeCount = stoi(values[0]);
+            else if (key == "output" && values.size() == 1)
+                output = values[0];
+            else if (key == "repetitions" && values.size() == 1 && stoi(values[0]) > 0)
+                repetitions = stoi(values[0]);
+            else if (key == "saveBaseline" && values.size() == 1)
+                saveBaseline = values[0];
+            else if (key == "compareBaseline" && values.size() == 1)
+                compareBaseline = values[0];
+            else if (key == "regressionThreshold" && values.size() == 1)
+                regressionThreshold = stod(values[0]);
+            else if (key == "qualityThreshold" && values.size() == 1)
+                qualityThreshold = stod(values[0]);
+            else
+                valid = false;
+        }
+        // Malformed numbers, thrown by stoi and stod as invalid_argument or out_of_range
+        catch (const logic_error &)
+        {
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            cerr << "Invalid option: " << key;
+            for (auto &v : values)
+                cerr << " " << v;
+            cerr << endl;
+            exit(1);
+        }
+    }
+
+    // Type graphs of each dataset and samples of each type graph, by default depending on the mode
+    int graphs() const
+    {
+        return numGraph != -1 ? numGraph : (stochastic ? 1 : 1000);
+    }
+
+    int samples() const
+    {
+        return numSample != -1 ? numSample : (stochastic ? 10000 : 100);
+    }
+
+    // Options that determine results, as one token, to check that a checkpoint belongs to this experiment
+    string fingerprint() const
+    {
+        ostringstream sout;
+        for (auto &d : datasets)
+            sout << d.first << "," << d.second << ";";
+        sout << stochastic << ";" << numGraph << ";" << numSample << ";" << hasSeed << ";" << seed << ";";
+        for (auto &a : algorithms)
+            sout << a << ",";
+        sout << ";" << useNatural << ";" << poissonSteps << ";" << targetHalfWidth << ";" << blockSize << ";"
+             << sampling << ";" << strata << ";" << controlVariate << ";" << repetitions << ";" << components << ";" << twins << ";" << reorder;
+        string res = sout.str();
+        replace(res.begin(), res.end(), ' ', '_');
+        return res;
+    }
+
+    // Read options from a config file
+    void read_file(const string &path)
+    {
+        ifstream fin(path);
+        if (!fin)
+        {
+            cerr << "Cannot open config file " << path << endl;
+            exit(1);
+        }
+
+        string line;
+        while (getline(fin, line))
+        {
+            istringstream sin(line);
+            string key, value;
+            vector<string> values;
+            if (!(sin >> key) || key[0] == '#')
+                continue;
+            while (sin >> value)
+                values.push_back(value);
+            set(key, values);
+        }
+    }
+
+    // Read options from command line: an optional config file, then options overriding it
+    // Datasets in command line replace those in the config file
+    void read_args(int argc, char **argv)
+    {
+        int i = 1;
+        if (i < argc && string(argv[i]).compare(0, 2, "--") != 0)
+            read_file(argv[i++]);
+        bool fileDatasets = true;
+
+        while (i < argc)
+        {
+            string key = argv[i++];
+            if (key.compare(0, 2, "--") != 0)
+            {
+                cerr << "Invalid argument: " << key << endl;
+                exit(1);
+            }
+            vector<string> values;
+            while (i < argc && string(argv[i]).compare(0, 2, "--") != 0)
+                values.push_back(argv[i++]);
+            if ((key == "--dataset" || key == "--synthetic") && fileDatasets)
+            {
+                datasets.clear();
+                fileDatasets = false;
+            }
+            set(key.substr(2), values);
+        }
+    }
+};
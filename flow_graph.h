@@ -1,14 +1,18 @@
 // Flow graph stored in adjacency list representation
+// Capacities are int, or long long for flows whose capacities are scaled by multiplicities (see twin_classes.h)
 
 
-struct flow_graph{
+template <class cap_t>
+struct basic_flow_graph{
     
     // Edge u -> v with capacity and flow
     // rev helps find the reversed edge v -> u
     struct edge
     {
-        int v, cap, flow, rev;
-        edge(int v, int cap, int flow, int rev) : v(v), cap(cap), flow(flow), rev(rev){}
+        int v;
+        cap_t cap, flow;
+        int rev;
+        edge(int v, cap_t cap, cap_t flow, int rev) : v(v), cap(cap), flow(flow), rev(rev){}
     };
     
     // Graph stored by adjacency lists
@@ -16,15 +20,18 @@ struct flow_graph{
     
     vector<int> dep, cur;
     
+    // Queue of BFS, kept to avoid allocation in repeated max flows
+    vector<int> que;
+    
     // Source and Sink
     int s, t;
     
-    const int inf = 1e9;
+    const cap_t inf = numeric_limits<cap_t>::max() / 2;
     
     
     // Initialize flow graph with source S and sink T
     // NOTE: Assume T is the vertex with largest label 
-    flow_graph(int S, int T)
+    basic_flow_graph(int S, int T)
     {
         s = S, t = T;
         adj.resize(t + 1);
@@ -32,8 +39,18 @@ struct flow_graph{
             adj[i] = {};
     }
 
+    // Clear the graph for reuse with source S and sink T, keeping allocated memory
+    void reset(int S, int T)
+    {
+        s = S, t = T;
+        if ((int)adj.size() < t + 1)
+            adj.resize(t + 1);
+        for (int i = 0; i <= t; i++)
+            adj[i].clear();
+    }
+
     // Add an edge x -> y with capacity
-    void add_edge(int x, int y, int cap)
+    void add_edge(int x, int y, cap_t cap)
     {
         int x_e = adj[x].size(), y_e = adj[y].size();
         adj[x].push_back(edge(y, cap, 0, y_e));
@@ -43,29 +60,27 @@ struct flow_graph{
     // Assign levels to vertices by BFS
     bool bfs()
     {
-        queue<int> q;
+        que.clear();
         fill(dep.begin(), dep.end(), 0);
         dep[s] = 1;
-        q.push(s);
-        do
+        que.push_back(s);
+        for (int head = 0; head < (int)que.size(); head++)
         {
-            int u = q.front();
-            q.pop();
+            int u = que[head];
             for (int u_e = 0; u_e < (int)adj[u].size(); u_e++){
                 int v = adj[u][u_e].v;
                 if (!dep[v] && adj[u][u_e].cap){
                     dep[v] = dep[u] + 1;
-                    q.push(v);
+                    que.push_back(v);
                 }
             }
         }
-        while(!q.empty());
         
         return dep[t];
     }
     
     // Send flows in G by DFS in level graph 
-    int dfs(int u, int num)
+    cap_t dfs(int u, cap_t num)
     {
         if ( (u == t) || !num ) return num;
         for (int &u_e = cur[u]; u_e < (int)adj[u].size(); u_e++)
@@ -73,7 +88,7 @@ struct flow_graph{
             int v = adj[u][u_e].v, v_e = adj[u][u_e].rev;
             if ((dep[v] == dep[u] + 1) && adj[u][u_e].cap)
             {
-                int d = dfs(v, min(num, adj[u][u_e].cap));
+                cap_t d = dfs(v, min(num, adj[u][u_e].cap));
                 if (d) {
                     adj[u][u_e].cap -= d;
                     adj[u][u_e].flow += d;
@@ -125,3 +140,5 @@ struct flow_graph{
     }
     
 };
+
+typedef basic_flow_graph<int> flow_graph;
@@ -0,0 +1,75 @@
+// Fused evaluation of online algorithms over one realization graph
+// All algorithms advance together, a tile of arrivals at a time, so the adjacency lists and probability rows
+// of a tile are streamed from memory by the first algorithm and read from cache by the others
+
+
+struct fused_algorithm{
+
+    // Run the algorithm on the current realization, up to the stop of its workspace
+    function<const vector<int> &(workspace &)> run;
+
+    // State of the algorithm, including its own random generator
+    workspace ws;
+
+    // Whether the algorithm still runs, e.g. until its results are precise enough
+    bool active;
+
+    // Wall time in seconds of the algorithm on the latest realization
+    double elapsed;
+
+    // Hardware events of the algorithm on all realizations, if counters are enabled
+    perf_stat perf;
+
+    // Memory allocated by the algorithm on all realizations, one call per realization
+    memory_stat memory;
+
+    // Events and memory of the tiles of the current realization
+    perf_stat tilePerf;
+    memory_stat tileMemory;
+
+    fused_algorithm(function<const vector<int> &(workspace &)> f) : run(f)
+    {
+        active = true;
+        elapsed = 0;
+    }
+};
+
+// Run all active algorithms on the current realization of g, tile arrivals at a time (tile = 1 interleaves every arrival)
+// The matching of each algorithm is left in its workspace, the same as running it alone with the same generator
+void fused_run(graph &g, vector<fused_algorithm> &algs, int tile = 16)
+{
+    int n = g.realization_size();
+    for (auto &alg : algs)
+    {
+        alg.ws.next = 0;
+        alg.elapsed = 0;
+    }
+
+    for (int stop = min(tile, n); ; stop = min(stop + tile, n))
+    {
+        for (auto &alg : algs)
+            if (alg.active)
+            {
+                alg.ws.stop = stop;
+                perf_scope counters(alg.tilePerf);
+                memory_scope allocated(alg.tileMemory);
+                double start = wall_time();
+                alg.run(alg.ws);
+                alg.elapsed += wall_time() - start;
+            }
+        if (stop >= n)
+            break;
+    }
+
+    // Tiles of a realization count as one call, and later standalone calls process whole realizations again
+    for (auto &alg : algs)
+    {
+        if (alg.tileMemory.calls > 0)
+            alg.memory.merge_call(alg.tileMemory);
+        if (alg.tilePerf.calls > 0)
+            alg.perf.merge_call(alg.tilePerf);
+        alg.tileMemory = memory_stat();
+        alg.tilePerf = perf_stat();
+        alg.ws.stop = -1;
+    }
+}
@@ -25,6 +25,59 @@ public:
         adj[j].push_back(i);
     }
     
+    // Replace all edges by neighbors of online types, whose lists are moved into the graph
+    // Offline neighbors are listed in order of online types, as if edges were added type by type
+    void set_online_adj(vector<vector<int>> &onAdj)
+    {
+        vector<int> degree(offSize, 0);
+        for (int i = 0; i < onSize; i++)
+            for (int j : onAdj[i])
+                degree[j - onSize]++;
+        for (int j = 0; j < offSize; j++)
+        {
+            adj[onSize + j].clear();
+            adj[onSize + j].reserve(degree[j]);
+        }
+        for (int i = 0; i < onSize; i++)
+        {
+            for (int j : onAdj[i])
+                adj[j].push_back(i);
+            adj[i].swap(onAdj[i]);
+        }
+    }
+
+    // Return the subgraph on vertices, the first numOnline of them online types, where vertex v is relabelled local[v]
+    // Vertices must cover whole connected components, and neighbors keep their order in each adjacency list
+    graph subgraph(const vector<int> &vertices, int numOnline, const vector<int> &local)
+    {
+        graph h(numOnline, vertices.size() - numOnline);
+        for (int k = 0; k < (int)vertices.size(); k++)
+        {
+            h.adj[k].reserve(adj[vertices[k]].size());
+            for (int v : adj[vertices[k]])
+                h.adj[k].push_back(local[v]);
+        }
+        return h;
+    }
+
+    // Set the id in the dataset of each vertex of a relabelled graph (see vertex_order.h)
+    void set_ids(vector<int> &vertexIds)
+    {
+        ids.swap(vertexIds);
+    }
+
+    // Return the id of vertex v in the dataset, which breaks ties as if the graph had not been relabelled
+    int id(int v) const
+    {
+        return ids.empty() ? v : ids[v];
+    }
+
+    // Return the twin classes of online types and of offline vertices
+    twin_classes twins()
+    {
+        return twin_classes(adj, onSize);
+    }
+
     // Return adjacency list
     vector<vector<int>> get_adj()
     {
@@ -37,6 +90,18 @@ public:
         return onSize;
     }
     
+    // Return number of offline vertices
+    int offline_size()
+    {
+        return offSize;
+    }
+    
+    // Return number of online vertices in realization graph
+    int realization_size()
+    {
+        return realSize;
+    }
+    
     // Print graph
     void print()
     {
@@ -70,6 +135,19 @@ public:
         }
     }
     
+    // Construct a realization graph with given type of each online vertex
+    void realize(const vector<int> &realTypes)
+    {
+        realSize = realTypes.size();
+        types = realTypes;
+    }
+    
+    // Return the type of each online vertex
+    const vector<int> &get_types()
+    {
+        return types;
+    }
+    
     //Print the type of each online vertex
     void print_type()
     {
@@ -80,47 +158,55 @@ public:
     
     
 //NOTE: All following functions compute matchings in realization graph
+//Online algorithms keep their state in a workspace, and return the matching stored in it
+//A call processes the arrivals up to workspace::stop, so a run can be resumed by later calls
     
-    vector<int> maximum_matching();
+    const vector<int> &maximum_matching(workspace &ws);
     
-    vector<int> sampling_without_replacement(map<pair<int, int>, double> &typeProb);
+    const vector<int> &sampling_without_replacement(workspace &ws, const vector<vector<double>> &edgeProb);
     map<pair<int, int>, double> optimal_matching_prob(int n_samples, int onSizeSample);
     
-    vector<int> regularized_greedy(map<pair<int, int>, double> &typeProb);
+    const vector<int> &regularized_greedy(workspace &ws, const vector<vector<double>> &edgeProb);
     
-    vector<int> balance_swor();
-    vector<int> balance_ocs();
+    const vector<int> &balance_swor(workspace &ws);
+    const vector<int> &balance_ocs(workspace &ws);
 
-    vector<int> poisson_ocs(const vector<double> &offMass, map<pair<int, int>, double> &typeProb);
+    const vector<int> &poisson_ocs(workspace &ws, const vector<double> &offMass, const vector<vector<double>> &edgeProb, const vector<double> &weight, int steps = 0);
+    vector<double> poisson_weight_table(const vector<double> &offMass, int steps);
     vector<double> poisson_offline_mass(map<pair<int, int>, double> &typeProb);
+    vector<vector<double>> edge_prob(const map<pair<int, int>, double> &typeProb);
 
-    vector<int> top_half_sampling(map<pair<int, int>, double> &typeProb);
+    const vector<int> &top_half_sampling(workspace &ws, const vector<vector<double>> &edgeProb);
     
-    vector<int> correlated_sampling(map<pair<int, int>, double> &typeProb);
+    const vector<int> &correlated_sampling(workspace &ws, const vector<vector<double>> &edgeProb);
     
     map<pair<int, int>, double> brubach_et_al_lp();
+    map<pair<int, int>, double> brubach_et_al_lp(const twin_classes &twins);
     vector<vector<pair<int, double>>> brubach_et_al_h(map<pair<int, int>, double> &lpSol);
-    vector<int> brubach_et_al(vector<vector<pair<int, double>>> h);
+    permutation_table brubach_et_al_table(const vector<vector<pair<int, double>>> &h);
+    const vector<int> &brubach_et_al(workspace &ws, const permutation_table &table);
     
     vector<vector<int>> jaillet_lu_list();
-    vector<int> jaillet_lu(vector<vector<int>> &jlList);
+    permutation_table jaillet_lu_table(const vector<vector<int>> &jlList);
+    const vector<int> &jaillet_lu(workspace &ws, const permutation_table &table);
     map<pair<int, int>, double> jaillet_lu_non_integral();
+    map<pair<int, int>, double> jaillet_lu_non_integral(const twin_classes &twins);
     
-    vector<int> manshadi_et_al(map<pair<int, int>, double> &typeProb);
+    const vector<int> &manshadi_et_al(workspace &ws, const vector<vector<double>> &edgeProb);
     
     tuple<vector<int>, vector<int>, vector<pair<int, int>>> haeupler_et_al_advice(map<pair<int, int>, double> lpPseudo);
-    vector<int> haeupler_et_al(const vector<int> &M1, const vector<int> &M2, const vector<pair<int, int>> &M3);
+    const vector<int> &haeupler_et_al(workspace &ws, const vector<int> &M1, const vector<int> &M2, const vector<pair<int, int>> &M3);
 
     
     pair<vector<int>, vector<int>> bahmani_kapralov_color();
-    vector<int> bahmani_kapralov(vector<int> &blue, vector<int> &red);
+    const vector<int> &bahmani_kapralov(workspace &ws, const vector<int> &blue, const vector<int> &red);
     
     pair<vector<int>, vector<int>> feldman_et_al_color();
-    vector<int> feldman_et_al(vector<int> &blue, vector<int> &red);
+    const vector<int> &feldman_et_al(workspace &ws, const vector<int> &blue, const vector<int> &red);
     
-    vector<int> min_degree();
+    const vector<int> &min_degree(workspace &ws, bool randomTie = false);
 
-    vector<int> ranking();
+    const vector<int> &ranking(workspace &ws);
 
     
 private:
@@ -128,6 +214,9 @@ private:
     // Adjacency list representation
     vector<vector<int>> adj;
     
+    // Id of each vertex in the dataset, empty if vertices keep their ids
+    vector<int> ids;
+
     // Type of each online vertex in realization graph
     vector<int> types;
     
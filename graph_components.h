@@ -0,0 +1,174 @@
+// Connected components of a type graph, packed into parts that are type graphs of their own
+// Preprocessing never interacts across components, so a stage runs on each part and its results are stitched
+// back to ids of the whole graph; components without edges need no preprocessing and belong to no part
+// Small components are packed together, so that a graph of thousands of components has few parts
+
+
+struct graph_components{
+
+    // Edges below which a part takes further components
+    static const int partEdges = 4096;
+
+    // Numbers of online types and offline vertices of the whole graph
+    int onSize, offSize;
+
+    // Type graph of each part, in increasing order of edges, if there are several parts
+    vector<graph> parts;
+
+    // Vertices of each part by local id, online types first, as ids of the whole graph
+    vector<vector<int>> vertex;
+
+    // Part of each vertex of the whole graph (-1 for none), and its local id in the part
+    vector<int> part, local;
+
+    graph_components(graph &g)
+    {
+        onSize = g.online_size();
+        offSize = g.offline_size();
+        int n = onSize + offSize;
+        vector<vector<int>> adj = g.get_adj();
+
+        // Components by union-find, labelled by their root
+        vector<int> parent(n);
+        iota(parent.begin(), parent.end(), 0);
+        auto root = [&](int v)
+        {
+            while (parent[v] != v)
+                v = parent[v] = parent[parent[v]];
+            return v;
+        };
+        for (int i = 0; i < onSize; i++)
+            for (int j : adj[i])
+                parent[root(i)] = root(j);
+
+        vector<long long> edges(n, 0);
+        for (int i = 0; i < onSize; i++)
+            edges[root(i)] += adj[i].size();
+        vector<int> roots;
+        for (int v = 0; v < n; v++)
+            if (root(v) == v && edges[v] > 0)
+                roots.push_back(v);
+        stable_sort(roots.begin(), roots.end(), [&](int a, int b) { return edges[a] < edges[b]; });
+
+        // Consecutive components in increasing order of edges are packed into parts of at least partEdges edges
+        vector<int> partOf(n, -1);
+        long long packed = 0;
+        int numPart = 0;
+        for (int r : roots)
+        {
+            if (packed >= partEdges || numPart == 0)
+                numPart++, packed = 0;
+            partOf[r] = numPart - 1;
+            packed += edges[r];
+        }
+
+        // Vertices keep their order within a part, online types first
+        part.assign(n, -1);
+        local.assign(n, -1);
+        vertex.assign(numPart, {});
+        vector<int> numOnline(numPart, 0);
+        for (int pass = 0; pass < 2; pass++)
+            for (int v = (pass ? onSize : 0); v < (pass ? n : onSize); v++)
+            {
+                int p = partOf[root(v)];
+                if (p == -1)
+                    continue;
+                part[v] = p;
+                local[v] = vertex[p].size();
+                vertex[p].push_back(v);
+                if (!pass)
+                    numOnline[p]++;
+            }
+
+        // A single part is the graph itself up to isolated vertices, so it is not copied
+        if (numPart > 1)
+            for (int p = 0; p < numPart; p++)
+                parts.push_back(g.subgraph(vertex[p], numOnline[p], local));
+    }
+
+    // Number of parts
+    int size() const
+    {
+        return vertex.size();
+    }
+
+    // Stitch results of parts back to ids of the whole graph:
+    // matching probabilities of edges, offline vertex of each online type (-1 for none),
+    // partner of each vertex (-1 for none), pair of offline vertices of each online type, values of each vertex
+
+    map<pair<int, int>, double> stitch(const vector<const map<pair<int, int>, double> *> &res) const
+    {
+        map<pair<int, int>, double> out;
+        for (int p = 0; p < size(); p++)
+            for (auto &item : *res[p])
+                out[make_pair(vertex[p][item.first.first], vertex[p][item.first.second])] = item.second;
+        return out;
+    }
+
+    vector<int> stitch_online(const vector<const vector<int> *> &res) const
+    {
+        vector<int> out(onSize, -1);
+        for (int p = 0; p < size(); p++)
+            for (int i = 0; i < (int)res[p]->size(); i++)
+                if ((*res[p])[i] != -1)
+                    out[vertex[p][i]] = vertex[p][(*res[p])[i]];
+        return out;
+    }
+
+    vector<int> stitch_vertices(const vector<const vector<int> *> &res) const
+    {
+        vector<int> out(onSize + offSize, -1);
+        for (int p = 0; p < size(); p++)
+            for (int v = 0; v < (int)res[p]->size(); v++)
+                if ((*res[p])[v] != -1)
+                    out[vertex[p][v]] = vertex[p][(*res[p])[v]];
+        return out;
+    }
+
+    vector<pair<int, int>> stitch_pairs(const vector<const vector<pair<int, int>> *> &res) const
+    {
+        vector<pair<int, int>> out(onSize, make_pair(-1, -1));
+        for (int p = 0; p < size(); p++)
+            for (int i = 0; i < (int)res[p]->size(); i++)
+            {
+                int x = (*res[p])[i].first, y = (*res[p])[i].second;
+                out[vertex[p][i]] = make_pair(x == -1 ? -1 : vertex[p][x], y == -1 ? -1 : vertex[p][y]);
+            }
+        return out;
+    }
+
+    template <class T>
+    vector<T> stitch_values(const vector<const vector<T> *> &res) const
+    {
+        vector<T> out(onSize + offSize);
+        for (int p = 0; p < size(); p++)
+            for (int v = 0; v < (int)res[p]->size(); v++)
+                out[vertex[p][v]] = (*res[p])[v];
+        return out;
+    }
+
+    // Table of orders of each online type, with the orders of its part and no order for types in no part
+    permutation_table stitch(const vector<const permutation_table *> &res) const
+    {
+        permutation_table out;
+        for (int i = 0; i < onSize; i++)
+        {
+            if (part[i] != -1)
+            {
+                const permutation_table &t = *res[part[i]];
+                const vector<int> &ids = vertex[part[i]];
+                for (int k = t.start[local[i]]; k < t.start[local[i] + 1]; k++)
+                {
+                    array<int, 3> order = t.order[k];
+                    for (int &j : order)
+                        if (j != -1)
+                            j = ids[j];
+                    out.order.push_back(order);
+                    out.cumProb.push_back(t.cumProb[k]);
+                }
+            }
+            out.finish_type();
+        }
+        return out;
+    }
+};
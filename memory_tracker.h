@@ -0,0 +1,209 @@
+// Accounting of heap memory of preprocessing stages and online algorithms, compiled in with -DMEMORY_TRACKING
+// Global operator new and delete are then replaced, so every C++ allocation carries a 16-byte header; without it,
+// allocations are untouched and memory scopes count nothing
+// A memory_scope counts allocations of the calling thread while it lives: number, bytes, and peak of live bytes
+// A block is uncounted when freed only if it was allocated in a scope of the same thread, so frees on another
+// thread do not lower its live bytes
+// Memory allocated inside GLPK by malloc is not counted, so the BrubachLp stage reports only the index arrays it builds,
+// not the rows, columns and factorization of the LP held by GLPK, which dominate its memory on large graphs
+// A scope with a budget throws memory_budget_exceeded, a bad_alloc, once its live bytes would exceed the budget
+
+
+#ifdef MEMORY_TRACKING
+const bool memoryTracking = true;
+#else
+const bool memoryTracking = false;
+#endif
+
+// Live bytes above which a preprocessing stage is aborted, 0 for no budget, set by the memoryBudget option
+long long stageMemoryBudget = 0;
+
+
+// Memory allocated in calls of one algorithm or stage
+struct memory_stat{
+
+    // Number of calls, allocations and bytes allocated over all calls
+    long long calls, allocations, bytes;
+
+    // Largest peak of live bytes (allocated and not freed in the call) over calls
+    long long peak;
+
+    memory_stat()
+    {
+        calls = 0;
+        allocations = 0;
+        bytes = 0;
+        peak = 0;
+    }
+
+    void merge(const memory_stat &other)
+    {
+        calls += other.calls;
+        allocations += other.allocations;
+        bytes += other.bytes;
+        peak = max(peak, other.peak);
+    }
+
+    // Add slices of one call, such as the tiles of a fused run, as a single call whose peak is the largest of a slice
+    void merge_call(const memory_stat &slices)
+    {
+        merge(slices);
+        calls -= slices.calls - 1;
+    }
+
+    void save(ostream &out) const
+    {
+        put(out, calls);
+        put(out, allocations);
+        put(out, bytes);
+        put(out, peak);
+    }
+
+    void load(istream &in)
+    {
+        get(in, calls);
+        get(in, allocations);
+        get(in, bytes);
+        get(in, peak);
+    }
+};
+
+
+// Counters of the innermost scope of a thread, plain data so that it is usable before any constructor runs
+struct memory_counter{
+    bool active;
+    long long allocations, bytes, live, peak, budget;
+};
+
+thread_local memory_counter currentMemory = {false, 0, 0, 0, 0, 0};
+
+
+// Live bytes of the scope and bytes requested when its budget was exceeded
+struct memory_budget_exceeded : public bad_alloc{
+
+    long long live, request;
+
+    memory_budget_exceeded(long long l, long long r)
+    {
+        live = l;
+        request = r;
+    }
+
+    const char *what() const noexcept
+    {
+        return "memory budget exceeded";
+    }
+};
+
+
+// Count allocations of the calling thread into stat while this object lives, within budget bytes if positive
+// Nested scopes count into the enclosing ones too
+struct memory_scope{
+
+    memory_stat &stat;
+    memory_counter outer;
+
+    memory_scope(memory_stat &s, long long budget = 0) : stat(s)
+    {
+        outer = currentMemory;
+        currentMemory = {true, 0, 0, 0, 0, budget};
+    }
+
+    ~memory_scope()
+    {
+        memory_counter inner = currentMemory;
+        stat.calls++;
+        stat.allocations += inner.allocations;
+        stat.bytes += inner.bytes;
+        stat.peak = max(stat.peak, inner.peak);
+
+        currentMemory = outer;
+        if (outer.active)
+        {
+            currentMemory.allocations += inner.allocations;
+            currentMemory.bytes += inner.bytes;
+            currentMemory.peak = max(currentMemory.peak, currentMemory.live + inner.peak);
+            currentMemory.live += inner.live;
+        }
+    }
+};
+
+
+#ifdef MEMORY_TRACKING
+
+// Header in front of each allocation, keeping the alignment of malloc: size, and counter of the allocating scope's
+// thread, or nullptr if no scope was active
+struct memory_header{
+    size_t size;
+    memory_counter *owner;
+};
+const size_t memoryHeader = 16;
+
+void *tracked_alloc(size_t size, bool nothrow)
+{
+    memory_counter &c = currentMemory;
+    if (c.active && c.budget > 0 && c.live + (long long)size > c.budget)
+    {
+        if (nothrow)
+            return nullptr;
+        throw memory_budget_exceeded(c.live, size);
+    }
+
+    char *p = (char *)malloc(size + memoryHeader);
+    if (p == nullptr)
+    {
+        if (nothrow)
+            return nullptr;
+        throw bad_alloc();
+    }
+    memory_header *h = (memory_header *)p;
+    h->size = size;
+    h->owner = c.active ? &c : nullptr;
+    if (c.active)
+    {
+        c.allocations++;
+        c.bytes += size;
+        c.live += size;
+        c.peak = max(c.peak, c.live);
+    }
+    return p + memoryHeader;
+}
+
+void tracked_free(void *ptr)
+{
+    if (ptr == nullptr)
+        return;
+    char *p = (char *)ptr - memoryHeader;
+    memory_header *h = (memory_header *)p;
+    if (h->owner == &currentMemory && currentMemory.active)
+        currentMemory.live -= h->size;
+    free(p);
+}
+
+void *operator new(size_t size) { return tracked_alloc(size, false); }
+void *operator new[](size_t size) { return tracked_alloc(size, false); }
+void *operator new(size_t size, const nothrow_t &) noexcept { return tracked_alloc(size, true); }
+void *operator new[](size_t size, const nothrow_t &) noexcept { return tracked_alloc(size, true); }
+void operator delete(void *ptr) noexcept { tracked_free(ptr); }
+void operator delete[](void *ptr) noexcept { tracked_free(ptr); }
+void operator delete(void *ptr, const nothrow_t &) noexcept { tracked_free(ptr); }
+void operator delete[](void *ptr, const nothrow_t &) noexcept { tracked_free(ptr); }
+#if __cplusplus >= 201402L
+void operator delete(void *ptr, size_t) noexcept { tracked_free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { tracked_free(ptr); }
+#endif
+
+#endif
+
+
+// Write memory of algorithms and stages as CSV
+// Each row is labelled by its kind and name, separated by a comma
+void save_memory(const vector<pair<string, const memory_stat *>> &rows, string csvPath)
+{
+    ofstream csv(csvPath);
+    csv << "kind,name,calls,allocations,allocated_bytes,peak_live_bytes" << endl;
+    for (auto &row : rows)
+        csv << row.first << "," << row.second->calls << "," << row.second->allocations << ","
+            << row.second->bytes << "," << row.second->peak << endl;
+    csv.close();
+}
@@ -11,10 +11,10 @@ private:
     const double eps_feas = 1e-3;
     double f_best = 0;
     int onSize, n;
-    double *x;
-    double *g_k;
-    double **P;
-    double *lambda;
+    vector<double> x;
+    vector<double> g_k;
+    vector<vector<double>> P;
+    vector<double> lambda;
 
 public:
     // Initialize
@@ -50,29 +50,17 @@ public:
             return typeProb;
         }
         // Initial point (0, 0, ..., 0) is feasible
-        P = (double **)malloc(sizeof(double *) * (n + 1));
-        g_k = (double *)malloc(sizeof(double) * (n + 1));
-        x = (double *)malloc(sizeof(double) * (n + 1));
-        lambda = (double *)malloc(sizeof(double) * (onSize));
-        
-
-        for (int i = 0; i < n + 1; i++)
-        {
-            *(P + i) = (double *)malloc(sizeof(double) * (n + 1));
-        }
-
-        for (int i = 0; i < n + 1; i++)
-            for (int j = 0; j < n + 1; j++)
-                P[i][j] = 0;
+        // Arrays are vectors, so that the (n + 1)^2 doubles of P are counted by memory scopes and budgets
+        P.assign(n + 1, vector<double>(n + 1, 0.0));
+        g_k.assign(n + 1, 0.0);
+        x.assign(n + 1, 0.0);
+        lambda.assign(onSize, 1.0);
 
         for (int i = 1; i < n + 1; i++)
         {
             P[i][i] = n / 4.0;
-            g_k[i] = 0;
             x[i] = 0.5;
         }
-        for (int i = 0; i < onSize; i++)
-            lambda[i] = 1;
 
         f_best = 0;
         while ( not iterate_ellipsoid() );
@@ -81,12 +69,8 @@ public:
             for (int j : adjLP[i])
                 typeProb[make_pair(i, j)] = x[eID[make_pair(i, j)]];
 
-        free(P);
-        P = nullptr;
-        free(g_k);
-        g_k = nullptr;
-        free(x);
-        x = nullptr;
+        P.clear();
+        g_k.clear();
 
         return typeProb;
     }
@@ -107,7 +91,7 @@ public:
     {
         double stop_value, sum;
 
-        fill(g_k, g_k + n + 1, 0.0);
+        fill(g_k.begin(), g_k.end(), 0.0);
 
         for (int i = 0; i < onSize; i++)
         {
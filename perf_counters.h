@@ -0,0 +1,289 @@
+// Hardware performance counters around online algorithms and preprocessing stages, by Linux perf_event_open
+// Counters that cannot be opened (other systems, containers, restricted perf_event_paranoid) are reported unavailable
+// The events are counted in two groups, cycles and instructions, and the cache, branch and TLB events, each led by
+// its first event that opens, so that a group that cannot be scheduled (e.g. with the NMI watchdog holding a generic
+// counter) does not leave the other unavailable; events of a group are counted over the same intervals, and if the
+// kernel multiplexes a group with other events, its counts are scaled by time enabled over time running and flagged
+
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum perf_event_kind
+{
+    perfCycles,
+    perfInstructions,
+    perfL1dMisses,
+    perfLlcMisses,
+    perfBranchMisses,
+    perfDtlbMisses,
+    numPerfEvent
+};
+
+const char *perfEventName[numPerfEvent] = {"cycles", "instructions", "L1dMisses", "LLCMisses", "branchMisses", "dTLBMisses"};
+
+// Group of each event
+const int numPerfGroup = 2;
+const int perfGroup[numPerfEvent] = {0, 0, 1, 1, 1, 1};
+
+// Whether counters are sampled, set by the perfCounters option
+bool perfEnabled = false;
+
+
+// Values of the events, -1 for unavailable ones, and nanoseconds each group was enabled and running
+struct perf_reading{
+    long long value[numPerfEvent];
+    long long enabled[numPerfGroup], running[numPerfGroup];
+};
+
+
+// Counters of user-space events of the calling thread, open while this object lives
+struct perf_counters{
+
+    // File descriptor of each counter, -1 if unavailable, and the leader of each group
+    int fd[numPerfEvent];
+    int leader[numPerfGroup];
+
+    // Position of each available event in a reading of its group, and number of available events of each group
+    int member[numPerfEvent];
+    int numMember[numPerfGroup];
+
+    perf_counters()
+    {
+        for (int k = 0; k < numPerfGroup; k++)
+            leader[k] = -1, numMember[k] = 0;
+        for (int e = 0; e < numPerfEvent; e++)
+            fd[e] = -1, member[e] = -1;
+#ifdef __linux__
+        const unsigned long long l1d = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const unsigned long long dtlb = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const pair<unsigned, unsigned long long> config[numPerfEvent] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, l1d},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, dtlb}};
+
+        for (int e = 0; e < numPerfEvent; e++)
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = config[e].first;
+            attr.config = config[e].second;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int k = perfGroup[e];
+            fd[e] = syscall(__NR_perf_event_open, &attr, 0, -1, leader[k], 0);
+            if (fd[e] == -1)
+                continue;
+            if (leader[k] == -1)
+                leader[k] = fd[e];
+            member[e] = numMember[k]++;
+        }
+#endif
+    }
+
+    ~perf_counters()
+    {
+#ifdef __linux__
+        for (int e = numPerfEvent - 1; e >= 0; e--)
+            if (fd[e] != -1)
+                close(fd[e]);
+#endif
+    }
+
+    // Read current values of each group at once
+    void read_all(perf_reading &r) const
+    {
+        for (int e = 0; e < numPerfEvent; e++)
+            r.value[e] = -1;
+        for (int k = 0; k < numPerfGroup; k++)
+            r.enabled[k] = r.running[k] = 0;
+#ifdef __linux__
+        // Layout of a group reading: number of events, time enabled, time running, then each value
+        for (int k = 0; k < numPerfGroup; k++)
+        {
+            long long buffer[3 + numPerfEvent];
+            ssize_t expected = (3 + numMember[k]) * sizeof(long long);
+            if (leader[k] == -1 || read(leader[k], buffer, sizeof(buffer)) != expected)
+                continue;
+            r.enabled[k] = buffer[1];
+            r.running[k] = buffer[2];
+            for (int e = 0; e < numPerfEvent; e++)
+                if (perfGroup[e] == k && member[e] != -1)
+                    r.value[e] = buffer[3 + member[e]];
+        }
+#endif
+    }
+};
+
+// Counters of the calling thread, opened on first use
+perf_counters &thread_perf_counters()
+{
+    thread_local perf_counters counters;
+    return counters;
+}
+
+
+// Events counted in calls of one algorithm or stage
+struct perf_stat{
+
+    // Total count of each event, and whether it was available in every call
+    long long total[numPerfEvent];
+    bool valid[numPerfEvent];
+    long long calls;
+
+    // Whether some count was scaled, because its group was multiplexed in a call
+    bool scaled;
+
+    perf_stat()
+    {
+        for (int e = 0; e < numPerfEvent; e++)
+        {
+            total[e] = 0;
+            valid[e] = true;
+        }
+        calls = 0;
+        scaled = false;
+    }
+
+    // Add the events between two readings, scaled by time enabled over time running of their group
+    void add(const perf_reading &before, const perf_reading &after)
+    {
+        for (int e = 0; e < numPerfEvent; e++)
+        {
+            int k = perfGroup[e];
+            long long enabled = after.enabled[k] - before.enabled[k], running = after.running[k] - before.running[k];
+
+            // A group that never ran in the call has no estimate
+            if (before.value[e] < 0 || after.value[e] < 0 || (enabled > 0 && running == 0))
+            {
+                valid[e] = false;
+                continue;
+            }
+            double scale = 1;
+            if (running < enabled)
+            {
+                scaled = true;
+                scale = (double)enabled / running;
+            }
+            total[e] += llround((after.value[e] - before.value[e]) * scale);
+        }
+        calls++;
+    }
+
+    void merge(const perf_stat &other)
+    {
+        for (int e = 0; e < numPerfEvent; e++)
+        {
+            total[e] += other.total[e];
+            valid[e] = valid[e] && other.valid[e];
+        }
+        calls += other.calls;
+        scaled = scaled || other.scaled;
+    }
+
+    // Add slices of one call, such as the tiles of a fused run, as a single call
+    void merge_call(const perf_stat &slices)
+    {
+        merge(slices);
+        calls -= slices.calls - 1;
+    }
+
+    void save(ostream &out) const
+    {
+        for (int e = 0; e < numPerfEvent; e++)
+        {
+            put(out, total[e]);
+            put(out, valid[e]);
+        }
+        put(out, calls);
+        put(out, scaled);
+    }
+
+    void load(istream &in)
+    {
+        for (int e = 0; e < numPerfEvent; e++)
+        {
+            get(in, total[e]);
+            get(in, valid[e]);
+        }
+        get(in, calls);
+        get(in, scaled);
+    }
+};
+
+
+// Add the events of a scope to a perf_stat, if counters are enabled
+struct perf_scope{
+
+    perf_stat &stat;
+    perf_reading start;
+
+    perf_scope(perf_stat &s) : stat(s)
+    {
+        if (perfEnabled)
+            thread_perf_counters().read_all(start);
+    }
+
+    ~perf_scope()
+    {
+        if (perfEnabled)
+        {
+            perf_reading stop;
+            thread_perf_counters().read_all(stop);
+            stat.add(start, stop);
+        }
+    }
+};
+
+
+// Return whether any counter can be opened, and warn once if none can
+bool check_perf_counters()
+{
+    perf_reading r;
+    thread_perf_counters().read_all(r);
+    for (int e = 0; e < numPerfEvent; e++)
+        if (r.value[e] >= 0)
+            return true;
+    cerr << "Hardware performance counters are unavailable, counters are reported as NA" << endl;
+    return false;
+}
+
+// Write counters of algorithms and stages as CSV, with NA for unavailable counters
+// Each row is labelled by its kind and name, separated by a comma; scaled is 1 if counts were scaled for multiplexing
+void save_counters(const vector<pair<string, const perf_stat *>> &rows, string csvPath)
+{
+    ofstream csv(csvPath);
+    csv << setprecision(6);
+    csv << "kind,name,calls";
+    for (int e = 0; e < numPerfEvent; e++)
+        csv << "," << perfEventName[e];
+    csv << ",IPC,LLCMissesPerKiloInstruction,scaled" << endl;
+
+    for (auto &row : rows)
+    {
+        const perf_stat &p = *row.second;
+        csv << row.first << "," << p.calls;
+        for (int e = 0; e < numPerfEvent; e++)
+        {
+            if (p.valid[e] && p.calls > 0)
+                csv << "," << p.total[e];
+            else
+                csv << ",NA";
+        }
+
+        bool ipc = p.calls > 0 && p.valid[perfCycles] && p.valid[perfInstructions] && p.total[perfCycles] > 0;
+        bool mpki = p.calls > 0 && p.valid[perfLlcMisses] && p.valid[perfInstructions] && p.total[perfInstructions] > 0;
+        csv << "," << (ipc ? to_string((double)p.total[perfInstructions] / p.total[perfCycles]) : "NA");
+        csv << "," << (mpki ? to_string(1000.0 * p.total[perfLlcMisses] / p.total[perfInstructions]) : "NA");
+        csv << "," << (p.scaled ? 1 : 0) << endl;
+    }
+    csv.close();
+}
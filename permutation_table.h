@@ -0,0 +1,62 @@
+// Flat table of candidate orders over at most three offline vertices for each online type
+// Used by the online phase of Brubach et al. (2016) and Jaillet and Lu (2013)
+
+
+struct permutation_table{
+
+    // Orders of online type i are stored in [start[i], start[i + 1])
+    vector<int> start;
+
+    // Offline vertices in the order they are probed, padded with -1
+    vector<array<int, 3>> order;
+
+    // Cumulative probability of each order within its online type
+    vector<double> cumProb;
+
+    // Construct an empty table
+    permutation_table()
+    {
+        start = {0};
+        order = {};
+        cumProb = {};
+    }
+
+    // Append an order to the latest online type, with its own (not cumulative) probability
+    void add_order(int v1, int v2, int v3, double prob)
+    {
+        double base = ((int)order.size() > start.back()) ? cumProb.back() : 0.0;
+        order.push_back(array<int, 3>{{v1, v2, v3}});
+        cumProb.push_back(base + prob);
+    }
+
+    // Close the orders of the latest online type
+    // If their probabilities were normalized, the last cumulative probability is set to exactly 1 against rounding,
+    // so that sampling always returns an order
+    void finish_type(bool normalized = false)
+    {
+        if (normalized && (int)order.size() > start.back())
+            cumProb.back() = 1.0;
+        start.push_back(order.size());
+    }
+
+    // Return the first order of type i whose cumulative probability reaches u, or nullptr if none
+    const array<int, 3> *sample(int i, double u) const
+    {
+        for (int k = start[i]; k < start[i + 1]; k++)
+            if (cumProb[k] >= u)
+                return &order[k];
+        return nullptr;
+    }
+
+    // Return the k-th order of type i
+    const array<int, 3> &get(int i, int k) const
+    {
+        return order[start[i] + k];
+    }
+
+    // Return the number of orders of type i
+    int size(int i) const
+    {
+        return start[i + 1] - start[i];
+    }
+};
@@ -0,0 +1,349 @@
+// Preprocessing of a type graph for online stochastic algorithms, split into stages
+// A stage is computed only when a selected algorithm needs it, after the stages it depends on
+// Independent stages run concurrently, each with its own stream of rng
+// Stages other than Monte-Carlo simulation and edge probabilities run on each part of the connected components
+// of the type graph (see graph_components.h) as separate tasks, smallest first, and their results are stitched
+
+
+enum preprocessing_stage
+{
+    stageTypeProb,          // Matching probabilities simulated by Monte-Carlo, and their edge probabilities
+    stageNaturalProb,       // Natural LP solution
+    stageEdgeProb,          // Edge probabilities, offline mass and weights of Poisson OCS
+    stageFeldmanColor,      // Blue and red edges of Feldman et al.
+    stageBahmaniColor,      // Blue and red edges of Bahmani and Kapralov
+    stageJailletLuTable,    // Lists of Jaillet and Lu
+    stageJailletLuNonInt,   // Flow of non-integral Jaillet and Lu
+    stageBrubachLp,         // LP of Brubach et al.
+    stageBrubachTable,      // Orders of Brubach et al.
+    stageHaeuplerAdvice,    // Advice of Haeupler et al.
+    numStage
+};
+
+// Names of stages in timing reports
+const char *stageName[numStage] = {"TypeProb", "NaturalProb", "EdgeProb", "FeldmanColor", "BahmaniColor",
+    "JailletLuTable", "JailletLuNonInt", "BrubachLp", "BrubachTable", "HaeuplerAdvice"};
+
+// Time, hardware events and memory spent in each stage over all type graphs
+// Each stage is written only by the thread computing it
+vector<timing_stat> stageTiming(stageName, stageName + numStage);
+vector<perf_stat> stagePerf(numStage);
+vector<memory_stat> stageMemory(numStage);
+
+// Whether stages run on parts of the connected components of type graphs with several parts, set by the components option
+bool splitComponents = true;
+
+// Whether the LP of Brubach et al. and the flow of non-integral Jaillet and Lu are solved on twin classes
+// (see twin_classes.h), set by the twins option; off by default, since the optimal solution found may differ
+bool compressTwins = false;
+
+// Whether stage s runs on each part of the components, the others depend on the whole graph
+bool per_component(preprocessing_stage s)
+{
+    return s != stageTypeProb && s != stageEdgeProb;
+}
+
+// Bit mask of a stage, used by algorithms to declare the stages they need
+unsigned stage_bit(preprocessing_stage s)
+{
+    return 1u << s;
+}
+
+
+struct preprocessing{
+
+    graph &g;
+
+    // Number of Monte-Carlo samples, whether natural LP replaces them, and time steps of Poisson OCS
+    int numSample;
+    bool useNatural;
+    int poissonSteps;
+
+    // Whether each stage has been computed, or failed by exceeding the memory budget, written by the thread computing it
+    vector<char> done, failed;
+
+    map<pair<int, int>, double> typeProb, naturalProb;
+    vector<vector<double>> typeEdgeProb, edgeProb;
+    vector<double> offMass, poissonWeight;
+
+    vector<int> blueF, redF, blueB, redB;
+
+    permutation_table jlTable;
+    vector<vector<double>> jlEdgeProb;
+
+    map<pair<int, int>, double> brubachLp;
+    permutation_table brubachTable;
+
+    vector<int> heauplerM1, heauplerM2;
+    vector<pair<int, int>> heauplerM3;
+
+    // Parts of the connected components, and preprocessing of each part, if the graph is split
+    shared_ptr<graph_components> components;
+    vector<shared_ptr<preprocessing>> partPre;
+
+    preprocessing(graph &typeGraph, int n, bool natural, int steps) : g(typeGraph)
+    {
+        numSample = n;
+        useNatural = natural;
+        poissonSteps = steps;
+        done.assign(numStage, false);
+        failed.assign(numStage, false);
+    }
+
+    // Return the stages that stage s directly depends on
+    vector<preprocessing_stage> depends(preprocessing_stage s) const
+    {
+        if (s == stageEdgeProb)
+            return {useNatural ? stageNaturalProb : stageTypeProb};
+        if (s == stageBrubachTable || s == stageHaeuplerAdvice)
+            return {stageBrubachLp};
+        return {};
+    }
+
+    // Compute stage s, whose dependencies have been computed, counting its time, events and memory
+    void compute(preprocessing_stage s, timing_stat &timing, perf_stat &perf, memory_stat &mem)
+    {
+        int realSize = g.online_size();
+        scoped_timer timer(timing);
+        perf_scope counters(perf);
+        memory_scope memory(mem, stageMemoryBudget);
+
+        switch (s)
+        {
+        case stageTypeProb:
+            typeProb = g.optimal_matching_prob(numSample, realSize);
+            typeEdgeProb = g.edge_prob(typeProb);
+            break;
+        case stageNaturalProb:
+            naturalProb = natural_lp(g.get_adj(), g.online_size()).solve_lp();
+            break;
+        case stageEdgeProb:
+            offMass = g.poisson_offline_mass(useNatural ? naturalProb : typeProb);
+            edgeProb = g.edge_prob(useNatural ? naturalProb : typeProb);
+            poissonWeight = g.poisson_weight_table(offMass, poissonSteps);
+            break;
+        case stageFeldmanColor:
+            tie(blueF, redF) = g.feldman_et_al_color();
+            break;
+        case stageBahmaniColor:
+            tie(blueB, redB) = g.bahmani_kapralov_color();
+            break;
+        case stageJailletLuTable:
+            jlTable = g.jaillet_lu_table(g.jaillet_lu_list());
+            break;
+        case stageJailletLuNonInt:
+            jlEdgeProb = g.edge_prob(compressTwins ? g.jaillet_lu_non_integral(g.twins()) : g.jaillet_lu_non_integral());
+            break;
+        case stageBrubachLp:
+            brubachLp = compressTwins ? g.brubach_et_al_lp(g.twins()) : g.brubach_et_al_lp();
+            break;
+        case stageBrubachTable:
+            brubachTable = g.brubach_et_al_table(g.brubach_et_al_h(brubachLp));
+            break;
+        case stageHaeuplerAdvice:
+            tie(heauplerM1, heauplerM2, heauplerM3) = g.haeupler_et_al_advice(brubachLp);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Stitch results of stage s on the parts into results of the whole graph
+    // Results of parts are kept, since later stages on the same part may still read them
+    void stitch(preprocessing_stage s)
+    {
+        graph_components &c = *components;
+        vector<const map<pair<int, int>, double> *> prob;
+        vector<const vector<int> *> first, second;
+        vector<const vector<pair<int, int>> *> pairs;
+        vector<const vector<vector<double>> *> edgeProbs;
+        vector<const permutation_table *> tables;
+        for (auto &pre : partPre)
+        {
+            prob.push_back(s == stageNaturalProb ? &pre->naturalProb : &pre->brubachLp);
+            first.push_back(s == stageFeldmanColor ? &pre->blueF : (s == stageBahmaniColor ? &pre->blueB : &pre->heauplerM1));
+            second.push_back(s == stageFeldmanColor ? &pre->redF : (s == stageBahmaniColor ? &pre->redB : &pre->heauplerM2));
+            pairs.push_back(&pre->heauplerM3);
+            edgeProbs.push_back(&pre->jlEdgeProb);
+            tables.push_back(s == stageJailletLuTable ? &pre->jlTable : &pre->brubachTable);
+        }
+
+        switch (s)
+        {
+        case stageNaturalProb:
+            naturalProb = c.stitch(prob);
+            break;
+        case stageFeldmanColor:
+            blueF = c.stitch_online(first);
+            redF = c.stitch_online(second);
+            break;
+        case stageBahmaniColor:
+            blueB = c.stitch_online(first);
+            redB = c.stitch_online(second);
+            break;
+        case stageJailletLuTable:
+            jlTable = c.stitch(tables);
+            break;
+        case stageJailletLuNonInt:
+            jlEdgeProb = c.stitch_values(edgeProbs);
+            break;
+        case stageBrubachLp:
+            brubachLp = c.stitch(prob);
+            break;
+        case stageBrubachTable:
+            brubachTable = c.stitch(tables);
+            break;
+        case stageHaeuplerAdvice:
+            heauplerM1 = c.stitch_vertices(first);
+            heauplerM2 = c.stitch_vertices(second);
+            heauplerM3 = c.stitch_pairs(pairs);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Compute stage s on pre, seeded by seed, and return whether it stays within the memory budget
+    bool attempt(preprocessing_stage s, preprocessing &pre, unsigned seed, timing_stat &timing, perf_stat &perf, memory_stat &mem)
+    {
+        rng.seed(seed);
+        try
+        {
+            pre.compute(s, timing, perf, mem);
+            return true;
+        }
+        catch (const memory_budget_exceeded &e)
+        {
+            ostringstream sout;
+            sout << "Stage " << stageName[s] << " aborted: " << e.live << " live bytes and a request of "
+                 << e.request << " bytes exceed the memory budget of " << stageMemoryBudget << " bytes, on a " << (&pre == this ? "type graph" : "part of components") << " of "
+                 << pre.g.online_size() << " online types and " << pre.g.offline_size() << " offline vertices" << endl;
+            cerr << sout.str();
+            return false;
+        }
+    }
+
+    // Compute all stages in the bit mask needs and the stages they depend on, on numThread threads
+    // Seeds of stages are drawn from rng of the calling thread, so results do not depend on numThread
+    // On a split graph, a stage on part p is seeded by (seed of the stage, p), and its time, events and memory
+    // count one call per part
+    // A stage exceeding the memory budget is aborted with a diagnostic, and so are the stages depending on it
+    // Return whether all stages are computed
+    bool prepare(unsigned needs, int numThread = max(1u, thread::hardware_concurrency()))
+    {
+        vector<unsigned> seed(numStage);
+        for (int s = 0; s < numStage; s++)
+            seed[s] = rng();
+
+        // Close needs under dependencies
+        for (int s = numStage - 1; s >= 0; s--)
+            if (needs & stage_bit((preprocessing_stage)s))
+                for (auto d : depends((preprocessing_stage)s))
+                    needs |= stage_bit(d);
+
+        // Split the graph into parts if a stage needs it
+        bool split = false;
+        for (int s = 0; s < numStage; s++)
+            split |= splitComponents && (needs & stage_bit((preprocessing_stage)s)) && !done[s] && per_component((preprocessing_stage)s);
+        if (split && !components)
+        {
+            components = make_shared<graph_components>(g);
+            for (auto &part : components->parts)
+                partPre.push_back(make_shared<preprocessing>(part, numSample, useNatural, poissonSteps));
+        }
+        int numPart = split ? components->size() : 0;
+        split = split && numPart > 1;
+
+        // Time, events and memory of each stage on each part, merged into those of the stage once all parts are done
+        vector<timing_stat> partTiming(numStage * numPart);
+        vector<perf_stat> partPerf(numStage * numPart);
+        vector<memory_stat> partMemory(numStage * numPart);
+
+        // Stages depend only on stages before them, so tasks are added in order of stages, and parts in increasing size
+        // A stage on a part depends on its dependencies on the same part, and the stitched stage on all its parts
+        task_graph tasks;
+        vector<int> task(numStage, -1);
+        vector<vector<int>> partTask(numStage, vector<int>(numPart, -1));
+        for (int s = 0; s < numStage; s++)
+        {
+            auto stage = (preprocessing_stage)s;
+            if (!(needs & stage_bit(stage)) || done[s])
+                continue;
+
+            if (split && per_component(stage))
+            {
+                for (int p = 0; p < numPart; p++)
+                {
+                    vector<int> deps;
+                    for (auto d : depends(stage))
+                        if (partTask[d][p] != -1)
+                            deps.push_back(partTask[d][p]);
+
+                    seed_seq seq{seed[s], (unsigned)p};
+                    unsigned partSeed;
+                    seq.generate(&partSeed, &partSeed + 1);
+                    int slot = s * numPart + p;
+                    partTask[s][p] = tasks.add_task([this, stage, p, partSeed, slot, &partTiming, &partPerf, &partMemory]()
+                    {
+                        preprocessing &pre = *partPre[p];
+                        for (auto d : depends(stage))
+                            if (pre.failed[d])
+                            {
+                                pre.failed[stage] = true;
+                                return;
+                            }
+                        if (attempt(stage, pre, partSeed, partTiming[slot], partPerf[slot], partMemory[slot]))
+                            pre.done[stage] = true;
+                        else
+                            pre.failed[stage] = true;
+                    }, deps);
+                }
+
+                task[s] = tasks.add_task([this, stage, numPart, &partTiming, &partPerf, &partMemory]()
+                {
+                    for (int p = 0; p < numPart; p++)
+                    {
+                        int slot = stage * numPart + p;
+                        stageTiming[stage].merge(partTiming[slot]);
+                        stagePerf[stage].merge(partPerf[slot]);
+                        stageMemory[stage].merge(partMemory[slot]);
+                        if (partPre[p]->failed[stage])
+                            failed[stage] = true;
+                    }
+                    if (!failed[stage])
+                    {
+                        stitch(stage);
+                        done[stage] = true;
+                    }
+                }, partTask[s]);
+                continue;
+            }
+
+            vector<int> deps;
+            for (auto d : depends(stage))
+                if (task[d] != -1)
+                    deps.push_back(task[d]);
+
+            unsigned stageSeed = seed[s];
+            task[s] = tasks.add_task([this, stage, stageSeed]()
+            {
+                for (auto d : depends(stage))
+                    if (failed[d])
+                    {
+                        failed[stage] = true;
+                        return;
+                    }
+                if (attempt(stage, *this, stageSeed, stageTiming[stage], stagePerf[stage], stageMemory[stage]))
+                    done[stage] = true;
+                else
+                    failed[stage] = true;
+            }, deps);
+        }
+        tasks.run(numThread);
+
+        for (int s = 0; s < numStage; s++)
+            if (failed[s])
+                return false;
+        return true;
+    }
+};
@@ -0,0 +1,247 @@
+// Timing instrumentation of online algorithms and preprocessing stages
+// A timed call costs two clock reads, so timers stay on in production runs
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+
+// Wall time in seconds since an arbitrary epoch
+double wall_time()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// CPU time of the calling thread in seconds, or wall time where no thread clock is available
+double thread_cpu_time()
+{
+#if defined(_WIN32)
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return wall_time();
+    // Times are in units of 100 ns
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime, k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime, u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 1e-7;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    return wall_time();
+#endif
+}
+
+// Peak resident memory of the process in KB since start or the latest reset, 0 if unknown (not Linux)
+long long peak_memory_kb()
+{
+    long long kb = 0;
+#ifdef __linux__
+    ifstream fin("/proc/self/status");
+    string line;
+    while (getline(fin, line))
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            kb = stoll(line.substr(6));
+#endif
+    return kb;
+}
+
+// Reset peak resident memory to current resident memory, if supported
+void reset_peak_memory()
+{
+#ifdef __linux__
+    ofstream fout("/proc/self/clear_refs");
+    fout << "5";
+#endif
+}
+
+
+// Histogram of latencies in logarithmic buckets, 8 per power of two from 1 ns
+// Percentiles are read from bucket bounds, within 9% of the exact value, and histograms merge by adding buckets
+struct latency_histogram{
+
+    static const int perOctave = 8, numBucket = 64 * perOctave;
+
+    vector<long long> bucket;
+    long long count;
+
+    latency_histogram()
+    {
+        bucket.assign(numBucket, 0);
+        count = 0;
+    }
+
+    // Add num latencies of the given seconds
+    void add(double seconds, long long num = 1)
+    {
+        double ns = max(seconds * 1e9, 1.0);
+        int b = min(numBucket - 1, (int)(log2(ns) * perOctave));
+        bucket[b] += num;
+        count += num;
+    }
+
+    void merge(const latency_histogram &other)
+    {
+        for (int b = 0; b < numBucket; b++)
+            bucket[b] += other.bucket[b];
+        count += other.count;
+    }
+
+    void save(ostream &out) const
+    {
+        put(out, bucket);
+        put(out, count);
+    }
+
+    void load(istream &in)
+    {
+        get(in, bucket);
+        get(in, count);
+    }
+
+    // Return the q-th quantile in seconds, as the upper bound of its bucket
+    double percentile(double q) const
+    {
+        if (count == 0)
+            return 0;
+        long long rank = (long long)ceil(q * count), seen = 0;
+        for (int b = 0; b < numBucket; b++)
+        {
+            seen += bucket[b];
+            if (seen >= max(rank, 1ll))
+                return pow(2.0, (b + 1.0) / perOctave) * 1e-9;
+        }
+        return pow(2.0, 64.0) * 1e-9;
+    }
+};
+
+
+// Time spent in calls of one algorithm or stage
+struct timing_stat{
+
+    string name;
+
+    // Number of calls (realizations of an algorithm), and items processed by them (arrivals)
+    long long calls, items;
+
+    // Total wall and CPU time in seconds
+    double wall, cpu;
+
+    // Wall time of each call
+    latency_histogram latency;
+
+    timing_stat(string s = "")
+    {
+        name = s;
+        calls = 0;
+        items = 0;
+        wall = 0;
+        cpu = 0;
+    }
+
+    // Add num calls processing items each, taking seconds of wall time altogether
+    void add(double seconds, long long itemsPerCall, long long num = 1, double cpuSeconds = 0)
+    {
+        calls += num;
+        items += itemsPerCall * num;
+        wall += seconds;
+        cpu += cpuSeconds;
+        latency.add(seconds / num, num);
+    }
+
+    void merge(const timing_stat &other)
+    {
+        calls += other.calls;
+        items += other.items;
+        wall += other.wall;
+        cpu += other.cpu;
+        latency.merge(other.latency);
+    }
+
+    void save(ostream &out) const
+    {
+        put(out, name);
+        put(out, calls);
+        put(out, items);
+        put(out, wall);
+        put(out, cpu);
+        latency.save(out);
+    }
+
+    void load(istream &in)
+    {
+        get(in, name);
+        get(in, calls);
+        get(in, items);
+        get(in, wall);
+        get(in, cpu);
+        latency.load(in);
+    }
+};
+
+
+// Add the wall and CPU time of a scope to a timing_stat, as one call
+struct scoped_timer{
+
+    timing_stat &stat;
+    long long items;
+    double startWall, startCpu;
+
+    scoped_timer(timing_stat &s, long long n = 1) : stat(s)
+    {
+        items = n;
+        startWall = wall_time();
+        startCpu = thread_cpu_time();
+    }
+
+    ~scoped_timer()
+    {
+        stat.add(wall_time() - startWall, items, 1, thread_cpu_time() - startCpu);
+    }
+};
+
+
+// Write timings of algorithms and stages as JSON and as CSV
+void save_timing(const vector<const timing_stat *> &algorithms, const vector<const timing_stat *> &stages, string jsonPath, string csvPath)
+{
+    auto rate = [](double num, double seconds) { return seconds > 0 ? num / seconds : 0.0; };
+
+    ofstream json(jsonPath);
+    json << setprecision(6);
+    json << "{" << endl << "  \"algorithms\": [";
+    for (int k = 0; k < (int)algorithms.size(); k++)
+    {
+        const timing_stat &t = *algorithms[k];
+        json << (k ? "," : "") << endl << "    {\"name\": \"" << t.name << "\", \"realizations\": " << t.calls
+             << ", \"arrivals\": " << t.items << ", \"seconds\": " << t.wall
+             << ", \"realizationsPerSecond\": " << rate(t.calls, t.wall) << ", \"arrivalsPerSecond\": " << rate(t.items, t.wall)
+             << ", \"latencyMicros\": {\"mean\": " << (t.calls ? t.wall / t.calls * 1e6 : 0)
+             << ", \"p50\": " << t.latency.percentile(0.5) * 1e6 << ", \"p90\": " << t.latency.percentile(0.9) * 1e6
+             << ", \"p99\": " << t.latency.percentile(0.99) * 1e6 << "}}";
+    }
+    json << endl << "  ]," << endl << "  \"stages\": [";
+    for (int k = 0; k < (int)stages.size(); k++)
+    {
+        const timing_stat &t = *stages[k];
+        json << (k ? "," : "") << endl << "    {\"name\": \"" << t.name << "\", \"calls\": " << t.calls
+             << ", \"wallSeconds\": " << t.wall << ", \"cpuSeconds\": " << t.cpu << "}";
+    }
+    json << endl << "  ]" << endl << "}" << endl;
+    json.close();
+
+    ofstream csv(csvPath);
+    csv << setprecision(6);
+    csv << "kind,name,calls,items,wall_s,cpu_s,calls_per_s,items_per_s,p50_us,p90_us,p99_us" << endl;
+    for (auto t : algorithms)
+        csv << "algorithm," << t->name << "," << t->calls << "," << t->items << "," << t->wall << ",,"
+            << rate(t->calls, t->wall) << "," << rate(t->items, t->wall) << "," << t->latency.percentile(0.5) * 1e6
+            << "," << t->latency.percentile(0.9) * 1e6 << "," << t->latency.percentile(0.99) * 1e6 << endl;
+    for (auto t : stages)
+        csv << "stage," << t->name << "," << t->calls << "," << t->items << "," << t->wall << "," << t->cpu
+            << "," << rate(t->calls, t->wall) << ",,,," << endl;
+    csv.close();
+}
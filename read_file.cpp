@@ -1,64 +1,101 @@
-graph generate_from_file(string path, bool dup = false, int subSample = 0)
+// Edge list of a dataset file, parsed once so that many type graphs are derived from it without reading the file again
+// Derivations only read the list, each with its own random generator, so instances may be derived by several threads
+struct edge_list{
+
+    // Number of vertices and edges, as in line 2 of the file
+    int n, m;
+
+    // Edges (x, y), with vertices indexed from 0
+    vector<pair<int, int>> edges;
+};
+
+// Parse a dataset file: line 1 is ignored, line 2 is "% m n", and each following line is an edge "x y" with
+// vertices indexed from 1, followed by an ignored weight
+// The file is read at once and scanned by hand, which is several times faster than extracting from a stream
+edge_list read_edge_list(const string &path)
 {
-    ifstream fin(path);
+    ifstream fin(path, ios::binary);
+    string text((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+    const char *p = text.c_str(), *end = p + text.size();
 
-    // Ignore line 1
-    string line;
-    getline(fin, line);
+    auto skip_line = [&]()
+    {
+        while (p < end && *p != '\n')
+            p++;
+        if (p < end)
+            p++;
+    };
+    auto read_int = [&]()
+    {
+        while (p < end && isspace((unsigned char)*p))
+            p++;
+        int x = 0;
+        while (p < end && isdigit((unsigned char)*p))
+            x = x * 10 + (*p++ - '0');
+        return x;
+    };
+
+    edge_list list;
+    skip_line();
 
     // Ignore the first character % in line 2
-    char ch;
-    int n, m;
-    
-    fin >> ch >> m >> n;
+    while (p < end && isspace((unsigned char)*p))
+        p++;
+    p++;
+    list.m = read_int();
+    list.n = read_int();
+    skip_line();
 
-    if (not dup)
+    list.edges.reserve(list.m);
+    for (int i = 0; i < list.m && p < end; i++)
     {
+        int x = read_int();
+        int y = read_int();
 
-        vector<int> id(n);
-        iota(id.begin(), id.end(), 0);
-        shuffle(id.begin(), id.end(), rng);
-        if (subSample != 0)
-            n = min(n, subSample);
-        
-        graph g(n / 2, n / 2);
-        
-        for (int i = 0; i < m; i++)
-        {
-            int x, y;
-            fin >> x >> y;
-            
-            // Ignore the third number in line
-            string line;
-            getline(fin, line);
+        // Ignore the third number in line
+        skip_line();
 
-            // Index starts from 1 in input file
-            x--, y--;
-
-            if (id[x] < n / 2 && id[y] >= n / 2 && id[y] < n / 2 + n / 2)
-                g.add_edge(id[x], id[y]);
-        }
-        fin.close();
-        return g;
+        // Index starts from 1 in input file
+        list.edges.push_back(make_pair(x - 1, y - 1));
     }
-    else
-    {
-        graph g(n, n);
-        for (int i = 0; i < m; i++)
-        {
-            int x, y;
-            fin >> x >> y;
-            
-            // Ignore the third number in line
-            string line;
-            getline(fin, line);
+    return list;
+}
+
+// Bipartite copy of the graph: online type x and offline vertex y for each edge (x, y)
+graph dup_graph(const edge_list &list)
+{
+    graph g(list.n, list.n);
+    for (auto &e : list.edges)
+        g.add_edge(e.first, list.n + e.second);
+    return g;
+}
 
-            // Index starts from 1 in input file
-            x--, y--;
+// Random induced bipartition, on the first subSample vertices of a random order if it is not 0:
+// the first half of the order are online types, the second half offline vertices, and other edges are dropped
+graph bipartition_graph(const edge_list &list, mt19937 &gen, int subSample = 0)
+{
+    int n = list.n;
+    vector<int> id(n);
+    iota(id.begin(), id.end(), 0);
+    shuffle(id.begin(), id.end(), gen);
+    if (subSample != 0)
+        n = min(n, subSample);
 
-            g.add_edge(x, n + y);
-        }
-        fin.close();
-        return g;
+    graph g(n / 2, n / 2);
+    for (auto &e : list.edges)
+    {
+        int x = id[e.first], y = id[e.second];
+        if (x < n / 2 && y >= n / 2 && y < n / 2 + n / 2)
+            g.add_edge(x, y);
     }
+    return g;
+}
+
+graph generate_from_file(string path, bool dup = false, int subSample = 0)
+{
+    edge_list list = read_edge_list(path);
+    if (not dup)
+        return bipartition_graph(list, rng, subSample);
+    else
+        return dup_graph(list);
 }
@@ -0,0 +1,140 @@
+// Sampling of realization graphs for variance reduction
+// Every realization has i.i.d. uniform types as in graph::realize, but realizations of a group are correlated:
+//   antithetic: pairs of realizations, where the second takes the type of opposite rank in degree order
+//   lhs: blocks of realizations, where the types of each online vertex are a Latin hypercube sample over the block
+// Means of groups are independent, so the variance of estimators is computed over groups
+
+
+enum sampling_mode
+{
+    samplingIid,
+    samplingAntithetic,
+    samplingLhs
+};
+
+// Number of correlated realizations in a group, for strata realizations in a Latin hypercube block
+int sampling_group_size(sampling_mode mode, int strata)
+{
+    if (mode == samplingAntithetic)
+        return 2;
+    return (mode == samplingLhs) ? strata : 1;
+}
+
+struct realization_sampler{
+
+    sampling_mode mode;
+
+    // Number of online types and online vertices
+    int onSize, realSize;
+
+    // Number of realizations in a Latin hypercube block
+    int strata;
+
+    // Online types sorted by degree
+    vector<int> byDegree;
+
+    // Ranks in byDegree of the types of realizations in the current group, rank[k * realSize + i]
+    vector<int> rank;
+
+    // Index of the next realization in the current group
+    int next;
+
+    // Online types of the latest realization, and types seen in it
+    vector<int> types;
+    epoch_flags seen;
+
+    realization_sampler(graph &g, sampling_mode m, int k = 16)
+    {
+        mode = m;
+        onSize = g.online_size();
+        realSize = onSize;
+        strata = (mode == samplingLhs) ? k : 1;
+        next = 0;
+
+        if (mode != samplingIid)
+        {
+            vector<vector<int>> adj = g.get_adj();
+            byDegree.resize(onSize);
+            iota(byDegree.begin(), byDegree.end(), 0);
+            stable_sort(byDegree.begin(), byDegree.end(), [&](int a, int b) { return adj[a].size() < adj[b].size(); });
+        }
+
+        types.resize(realSize);
+    }
+
+    // Number of correlated realizations in a group
+    int group_size() const
+    {
+        return sampling_group_size(mode, strata);
+    }
+
+    // Draw ranks of all realizations of a new group
+    void draw_group()
+    {
+        uniform_int_distribution<int> rankDist(0, onSize - 1);
+        if (mode == samplingAntithetic)
+        {
+            rank.resize(2 * realSize);
+            for (int i = 0; i < realSize; i++)
+            {
+                rank[i] = rankDist(rng);
+                rank[realSize + i] = onSize - 1 - rank[i];
+            }
+        }
+        else
+        {
+            // Realization k takes the type of stratum perm[k] of [0, 1) for each online vertex
+            rank.resize((size_t)strata * realSize);
+            vector<int> perm(strata);
+            uniform_real_distribution<double> unit(0.0, 1.0);
+            for (int i = 0; i < realSize; i++)
+            {
+                iota(perm.begin(), perm.end(), 0);
+                shuffle(perm.begin(), perm.end(), rng);
+                for (int k = 0; k < strata; k++)
+                {
+                    double u = (perm[k] + unit(rng)) / strata;
+                    rank[(size_t)k * realSize + i] = min(onSize - 1, (int)(u * onSize));
+                }
+            }
+        }
+    }
+
+    // Construct the next realization of g
+    void realize(graph &g)
+    {
+        if (mode == samplingIid)
+        {
+            g.realize(realSize);
+            types = g.get_types();
+            return;
+        }
+
+        if (next == 0)
+            draw_group();
+        for (int i = 0; i < realSize; i++)
+            types[i] = byDegree[rank[(size_t)next * realSize + i]];
+        next = (next + 1) % group_size();
+        g.realize(types);
+    }
+
+    // Control variate of the latest realization: number of distinct online types
+    int control()
+    {
+        seen.reset(onSize);
+        int num = 0;
+        for (int t : types)
+            if (!seen.test(t))
+            {
+                seen.set(t);
+                num++;
+            }
+        return num;
+    }
+
+    // Expected number of distinct online types in a realization
+    double control_mean() const
+    {
+        return onSize * (1 - pow(1 - 1.0 / onSize, realSize));
+    }
+};
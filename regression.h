@@ -0,0 +1,297 @@
+// Performance and quality regressions of an experiment against a stored baseline
+// A baseline is a versioned JSON file of metrics, each with one value per repetition of the experiment:
+// throughput and latency of algorithms, time of preprocessing stages, peak memory, and ratio to OPT on datasets
+// A metric regresses if it gets worse by more than a threshold, and the change is significant:
+// by Welch's t-test over repetitions, or for ratios to OPT of single repetitions by their confidence intervals
+
+
+const int baselineVersion = 1;
+
+// Significance level of tests
+const double regressionAlpha = 0.05;
+
+
+// Values of one metric over repetitions
+struct regression_metric{
+
+    string name;
+
+    // Whether larger values are better, and whether it is a ratio to OPT (compared by absolute change)
+    bool higherBetter, quality;
+
+    // Value, and half-width of its confidence interval for ratios to OPT, in each repetition
+    vector<double> values, halfWidth;
+
+    double mean() const
+    {
+        double sum = 0;
+        for (double v : values)
+            sum += v;
+        return values.empty() ? 0 : sum / values.size();
+    }
+
+    double variance() const
+    {
+        if (values.size() < 2)
+            return 0;
+        double mu = mean(), sum = 0;
+        for (double v : values)
+            sum += (v - mu) * (v - mu);
+        return sum / (values.size() - 1);
+    }
+};
+
+
+// Regularized incomplete beta function I_x(a, b), by continued fraction
+double incomplete_beta(double a, double b, double x)
+{
+    if (x <= 0 || x >= 1)
+        return x <= 0 ? 0 : 1;
+    if (x > (a + 1) / (a + b + 2))
+        return 1 - incomplete_beta(b, a, 1 - x);
+
+    const double tiny = 1e-300;
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x)) / a;
+    double c = 1, d = 1 - (a + b) * x / (a + 1);
+    d = 1 / (fabs(d) < tiny ? tiny : d);
+    double f = d;
+    for (int i = 1; i <= 200; i++)
+    {
+        // Even and odd terms of the continued fraction
+        for (int odd = 0; odd < 2; odd++)
+        {
+            double num = odd ? -(a + i) * (a + b + i) * x / ((a + 2 * i) * (a + 2 * i + 1))
+                             : i * (b - i) * x / ((a + 2 * i - 1) * (a + 2 * i));
+            d = 1 + num * d;
+            d = 1 / (fabs(d) < tiny ? tiny : d);
+            c = 1 + num / c;
+            c = fabs(c) < tiny ? tiny : c;
+            f *= c * d;
+        }
+        if (fabs(c * d - 1) < 1e-12)
+            break;
+    }
+    return front * f;
+}
+
+// Two-sided p-value of t-test for equal means: Welch's test if both samples have two values or more,
+// and whether a single value is outside the prediction interval of the other sample if one has a single value
+// Return 1 if no test applies
+double welch_p_value(const regression_metric &a, const regression_metric &b)
+{
+    int na = a.values.size(), nb = b.values.size();
+    if (max(na, nb) < 2 || min(na, nb) < 1)
+        return 1;
+
+    double var, df;
+    if (na > 1 && nb > 1)
+    {
+        double va = a.variance() / na, vb = b.variance() / nb;
+        var = va + vb;
+        df = var * var / (va * va / (na - 1) + vb * vb / (nb - 1));
+    }
+    else
+    {
+        const regression_metric &many = (na > 1) ? a : b;
+        var = many.variance() * (1 + 1.0 / many.values.size());
+        df = many.values.size() - 1;
+    }
+    if (var == 0)
+        return fabs(a.mean() - b.mean()) <= 1e-9 * fabs(b.mean()) ? 1 : 0;
+    double t = (a.mean() - b.mean()) / sqrt(var);
+    return incomplete_beta(df / 2, 0.5, df / (df + t * t));
+}
+
+
+// Metrics of an experiment, in the order they are recorded
+struct regression_record{
+
+    int version, repetitions;
+    vector<regression_metric> metrics;
+    map<string, int> index;
+
+    regression_record()
+    {
+        version = baselineVersion;
+        repetitions = 0;
+    }
+
+    // Return the metric of a name, added if new
+    regression_metric &metric(const string &name, bool higherBetter = false, bool quality = false)
+    {
+        auto it = index.find(name);
+        if (it != index.end())
+            return metrics[it->second];
+        index[name] = metrics.size();
+        regression_metric m;
+        m.name = name;
+        m.higherBetter = higherBetter;
+        m.quality = quality;
+        metrics.push_back(m);
+        return metrics.back();
+    }
+
+    // Write and read the metrics for checkpoints
+    void save(ostream &out) const
+    {
+        put(out, repetitions);
+        put(out, (int)metrics.size());
+        for (auto &m : metrics)
+        {
+            put(out, m.name);
+            put(out, m.higherBetter);
+            put(out, m.quality);
+            put(out, m.values);
+            put(out, m.halfWidth);
+        }
+    }
+
+    void load(istream &in)
+    {
+        int size;
+        get(in, repetitions);
+        get(in, size);
+        for (int k = 0; k < size; k++)
+        {
+            string name;
+            get(in, name);
+            regression_metric &m = metric(name);
+            get(in, m.higherBetter);
+            get(in, m.quality);
+            get(in, m.values);
+            get(in, m.halfWidth);
+        }
+    }
+
+    void save(const string &path) const
+    {
+        ofstream fout(path);
+        fout << setprecision(10);
+        fout << "{" << endl << "  \"version\": " << version << "," << endl << "  \"repetitions\": " << repetitions
+             << "," << endl << "  \"metrics\": [";
+        for (int k = 0; k < (int)metrics.size(); k++)
+        {
+            const regression_metric &m = metrics[k];
+            fout << (k ? "," : "") << endl << "    {\"name\": \"" << m.name << "\", \"higherBetter\": " << (m.higherBetter ? "true" : "false")
+                 << ", \"quality\": " << (m.quality ? "true" : "false") << ", \"values\": [";
+            for (int r = 0; r < (int)m.values.size(); r++)
+                fout << (r ? ", " : "") << m.values[r];
+            fout << "], \"halfWidth\": [";
+            for (int r = 0; r < (int)m.halfWidth.size(); r++)
+                fout << (r ? ", " : "") << m.halfWidth[r];
+            fout << "]}";
+        }
+        fout << endl << "  ]" << endl << "}" << endl;
+        fout.close();
+    }
+
+    // Read a baseline written by save, and exit if it cannot be read or has another version
+    void load(const string &path)
+    {
+        ifstream fin(path);
+        if (!fin)
+        {
+            cerr << "Cannot open baseline " << path << endl;
+            exit(1);
+        }
+        string text((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+
+        // Value after "key": in text from position pos
+        auto field = [&](const string &key, size_t pos) -> size_t
+        {
+            size_t at = text.find("\"" + key + "\":", pos);
+            return at == string::npos ? string::npos : at + key.size() + 3;
+        };
+        auto numbers = [&](size_t pos)
+        {
+            vector<double> res;
+            size_t end = text.find(']', pos);
+            istringstream sin(text.substr(pos + 2, end - pos - 2));
+            string item;
+            while (getline(sin, item, ','))
+                if (item.find_first_not_of(" ") != string::npos)
+                    res.push_back(stod(item));
+            return res;
+        };
+
+        size_t pos = field("version", 0);
+        if (pos == string::npos || atoi(text.c_str() + pos) != baselineVersion)
+        {
+            cerr << "Baseline " << path << " is not of version " << baselineVersion << endl;
+            exit(1);
+        }
+        repetitions = atoi(text.c_str() + field("repetitions", 0));
+
+        for (pos = field("name", 0); pos != string::npos; pos = field("name", pos))
+        {
+            size_t end = text.find('"', pos + 2);
+            regression_metric &m = metric(text.substr(pos + 2, end - pos - 2));
+            m.higherBetter = text.compare(field("higherBetter", pos) + 1, 4, "true") == 0;
+            m.quality = text.compare(field("quality", pos) + 1, 4, "true") == 0;
+            m.values = numbers(field("values", pos));
+            m.halfWidth = numbers(field("halfWidth", pos));
+        }
+    }
+};
+
+
+// Compare a run with a baseline, print and save the comparison as CSV, and return whether any metric regresses
+// Performance metrics regress by relative change above threshold, ratios to OPT by absolute change above qualityThreshold
+// Performance metrics with a single repetition on both sides are untested, since timing noise cannot be estimated
+bool compare_with_baseline(const regression_record &run, const regression_record &base, double threshold, double qualityThreshold, string csvPath)
+{
+    ofstream csv(csvPath);
+    csv << setprecision(6);
+    csv << "metric,baseline,current,change,p_value,status" << endl;
+    int numRegression = 0;
+
+    for (auto &m : run.metrics)
+    {
+        auto it = base.index.find(m.name);
+        if (it == base.index.end())
+        {
+            csv << m.name << ",," << m.mean() << ",,,new" << endl;
+            continue;
+        }
+        const regression_metric &b = base.metrics[it->second];
+        double bm = b.mean(), cm = m.mean();
+
+        // Change towards worse values, relative for performance and absolute for ratios to OPT
+        double change = m.higherBetter ? bm - cm : cm - bm;
+        if (!m.quality)
+            change = bm != 0 ? change / fabs(bm) : 0;
+
+        double p = welch_p_value(m, b);
+        bool significant = p < regressionAlpha;
+        if (m.values.size() < 2 && b.values.size() < 2)
+        {
+            // Single repetitions: confidence intervals of ratios to OPT; performance has no estimate of its noise,
+            // so it is reported untested and never counts as a regression
+            p = numeric_limits<double>::quiet_NaN();
+            if (!m.quality || m.halfWidth.empty() || b.halfWidth.empty())
+            {
+                csv << m.name << "," << bm << "," << cm << "," << change << "," << p << ",untested" << endl;
+                continue;
+            }
+            significant = fabs(cm - bm) > sqrt(m.halfWidth[0] * m.halfWidth[0] + b.halfWidth[0] * b.halfWidth[0]);
+        }
+
+        double limit = m.quality ? qualityThreshold : threshold;
+        string status = "ok";
+        if (significant && change > limit)
+            status = "regression", numRegression++;
+        else if (significant && -change > limit)
+            status = "improvement";
+
+        csv << m.name << "," << bm << "," << cm << "," << change << "," << p << "," << status << endl;
+        if (status != "ok")
+            cerr << (status == "regression" ? "REGRESSION " : "Improvement ") << m.name << ": " << bm << " -> " << cm << endl;
+    }
+    for (auto &b : base.metrics)
+        if (run.index.find(b.name) == run.index.end())
+            csv << b.name << "," << b.mean() << ",,,,missing" << endl;
+    csv.close();
+
+    cerr << numRegression << " regression(s) against baseline, details in " << csvPath << endl;
+    return numRegression > 0;
+}
@@ -0,0 +1,319 @@
+// Streaming statistics of a sequence of values, without storing the values
+// Mean and variance are updated by Welford's method, and two accumulators merge into the accumulator
+// of both sequences by the pairwise formula of Chan et al., so per-thread accumulators combine without buffers
+
+
+struct running_stat{
+
+    // Number of values
+    long long count;
+
+    // Mean, and sum of squared deviations from the mean
+    double mean, m2;
+
+    // Minimum and maximum value
+    double minV, maxV;
+
+    running_stat()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+        minV = numeric_limits<double>::infinity();
+        maxV = -numeric_limits<double>::infinity();
+    }
+
+    // Add one value
+    void add(double x)
+    {
+        count++;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        minV = min(minV, x);
+        maxV = max(maxV, x);
+    }
+
+    // Add all values of another accumulator
+    void merge(const running_stat &other)
+    {
+        if (other.count == 0)
+            return;
+        if (count == 0)
+        {
+            *this = other;
+            return;
+        }
+
+        long long n = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / n;
+        m2 += other.m2 + delta * delta * ((double)count * other.count / n);
+        count = n;
+        minV = min(minV, other.minV);
+        maxV = max(maxV, other.maxV);
+    }
+
+    // Sample variance, 0 for less than two values
+    double variance() const
+    {
+        return count > 1 ? m2 / (count - 1) : 0;
+    }
+
+    // Write and read the state for checkpoints
+    void save(ostream &out) const
+    {
+        put(out, count);
+        put(out, mean);
+        put(out, m2);
+        put(out, minV);
+        put(out, maxV);
+    }
+
+    void load(istream &in)
+    {
+        get(in, count);
+        get(in, mean);
+        get(in, m2);
+        get(in, minV);
+        get(in, maxV);
+    }
+
+    // Sample standard deviation
+    double std_dev() const
+    {
+        return sqrt(variance());
+    }
+};
+
+
+// Streaming statistics of pairs of values (x, y) from the same sample, e.g. an algorithm and OPT on one realization
+// Used for the ratio of means of x and y, whose variance depends on the covariance of x and y
+struct running_pair{
+
+    running_stat x, y;
+
+    // Sum of products of deviations of x and y from their means
+    double cxy;
+
+    running_pair()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        x.clear();
+        y.clear();
+        cxy = 0;
+    }
+
+    void add(double vx, double vy)
+    {
+        double dx = vx - x.mean;
+        x.add(vx);
+        y.add(vy);
+        cxy += dx * (vy - y.mean);
+    }
+
+    void merge(const running_pair &other)
+    {
+        if (other.x.count == 0)
+            return;
+        double n1 = x.count, n2 = other.x.count;
+        cxy += other.cxy + (other.x.mean - x.mean) * (other.y.mean - y.mean) * (n1 * n2 / (n1 + n2));
+        x.merge(other.x);
+        y.merge(other.y);
+    }
+
+    // Ratio of mean of x to mean of y
+    double ratio() const
+    {
+        return x.mean / y.mean;
+    }
+
+    void save(ostream &out) const
+    {
+        x.save(out);
+        y.save(out);
+        put(out, cxy);
+    }
+
+    void load(istream &in)
+    {
+        x.load(in);
+        y.load(in);
+        get(in, cxy);
+    }
+
+    // Half-width of the confidence interval of the ratio with z standard errors, by the delta method
+    double ratio_half_width(double z) const
+    {
+        if (x.count < 2 || y.mean == 0)
+            return numeric_limits<double>::infinity();
+        double r = ratio();
+        double cov = cxy / (x.count - 1);
+        double var = (x.variance() - 2 * r * cov + r * r * y.variance()) / (x.count * y.mean * y.mean);
+        return z * sqrt(max(var, 0.0));
+    }
+};
+
+
+// Estimator of the ratio of mean of x to mean of y, e.g. an algorithm to OPT
+// Samples may come in groups of groupSize correlated samples (antithetic pairs, Latin hypercube blocks),
+// whose means are independent; a control variate c of known mean may correct the estimate
+struct ratio_stat{
+
+    int groupSize;
+
+    // Whether c is used as a control variate, and its known mean
+    bool useControl;
+    double controlMean;
+
+    // Statistics of single samples and of means of complete groups; samples of an incomplete group are in neither,
+    // so that the ratio and the statistics of single samples are over the same samples, also after merges
+    running_pair single, xy, xc, yc;
+
+    // Sums and samples of the current incomplete group
+    double gx, gy, gc;
+    int gn;
+    vector<pair<double, double>> pending;
+
+    ratio_stat(int size = 1, bool control = false, double mean = 0)
+    {
+        groupSize = size;
+        useControl = control;
+        controlMean = mean;
+        clear();
+    }
+
+    void clear()
+    {
+        single.clear();
+        xy.clear();
+        xc.clear();
+        yc.clear();
+        gx = gy = gc = 0;
+        gn = 0;
+        pending.clear();
+    }
+
+    void add(double x, double y, double c = 0)
+    {
+        if (groupSize == 1)
+            single.add(x, y);
+        else
+            pending.push_back(make_pair(x, y));
+        gx += x, gy += y, gc += c;
+        if (++gn == groupSize)
+        {
+            for (auto &p : pending)
+                single.add(p.first, p.second);
+            pending.clear();
+            xy.add(gx / gn, gy / gn);
+            xc.add(gx / gn, gc / gn);
+            yc.add(gy / gn, gc / gn);
+            gx = gy = gc = 0;
+            gn = 0;
+        }
+    }
+
+    // Add all complete groups of another estimator with the same settings
+    void merge(const ratio_stat &other)
+    {
+        single.merge(other.single);
+        xy.merge(other.xy);
+        xc.merge(other.xc);
+        yc.merge(other.yc);
+    }
+
+    // Write and read the state for checkpoints, including the current incomplete group
+    void save(ostream &out) const
+    {
+        put(out, groupSize);
+        put(out, useControl);
+        put(out, controlMean);
+        single.save(out);
+        xy.save(out);
+        xc.save(out);
+        yc.save(out);
+        put(out, gx);
+        put(out, gy);
+        put(out, gc);
+        put(out, gn);
+        put(out, pending);
+    }
+
+    void load(istream &in)
+    {
+        get(in, groupSize);
+        get(in, useControl);
+        get(in, controlMean);
+        single.load(in);
+        xy.load(in);
+        xc.load(in);
+        yc.load(in);
+        get(in, gx);
+        get(in, gy);
+        get(in, gc);
+        get(in, gn);
+        get(in, pending);
+    }
+
+    // Number of single samples in complete groups
+    long long count() const
+    {
+        return single.x.count;
+    }
+
+    // Coefficient of control variate for residual x - ratio * y, 0 without control
+    double control_coef() const
+    {
+        if (!useControl || xy.x.count < 2 || xc.y.variance() == 0)
+            return 0;
+        double cov = (xc.cxy - xy.ratio() * yc.cxy) / (xy.x.count - 1);
+        return cov / xc.y.variance();
+    }
+
+    // Estimated ratio, corrected by the control variate
+    double ratio() const
+    {
+        return xy.ratio() - control_coef() * (xc.y.mean - controlMean) / xy.y.mean;
+    }
+
+    // Variance of the estimated ratio, by the delta method over group means
+    double variance() const
+    {
+        long long n = xy.x.count;
+        if (n < 2 || xy.y.mean == 0)
+            return numeric_limits<double>::infinity();
+        double r = xy.ratio();
+        double var = xy.x.variance() - 2 * r * xy.cxy / (n - 1) + r * r * xy.y.variance();
+        double b = control_coef();
+        var -= b * b * xc.y.variance();
+        return max(var, 0.0) / (n * xy.y.mean * xy.y.mean);
+    }
+
+    // Half-width of the confidence interval of the ratio with z standard errors
+    double half_width(double z) const
+    {
+        return z * sqrt(variance());
+    }
+
+    // Variance reduction factor: variance of the plain estimator from as many independent samples, over variance()
+    double reduction() const
+    {
+        long long n = xy.x.count * groupSize;
+        if (n < 2 || single.y.mean == 0)
+            return 1;
+        double r = single.ratio();
+        double plain = (single.x.variance() - 2 * r * single.cxy / (single.x.count - 1) + r * r * single.y.variance()) / (n * single.y.mean * single.y.mean);
+        double var = variance();
+        return var > 0 ? plain / var : 1;
+    }
+};
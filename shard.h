@@ -0,0 +1,127 @@
+// Sharded experiments over independent worker processes on one host, without any network service
+// Units of work are (dataset, type graph, block of samples) in this order, and shard k of n does the k-th of n
+// contiguous ranges of units, so a type graph is preprocessed by few shards
+// Preprocessing of a type graph draws from rng seeded by (seed, dataset, graph), and each block of samples
+// from rng seeded by (seed, dataset, graph, block), so the results of a unit do not depend on the shard doing it
+// Each shard writes the results of its units into a partial file, merged in order of units into the result files
+
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+struct shard_plan{
+
+    // Index of this shard and number of shards, 0 if the experiment is not sharded
+    int index, count;
+
+    // Seed shared by all shards
+    unsigned seed;
+
+    // Type graphs of each dataset and blocks of samples of each type graph
+    int numGraph, numBlock;
+
+    // Units of work of this shard, [first, last)
+    long long first, last;
+
+    shard_plan()
+    {
+        index = 0;
+        count = 0;
+        seed = 0;
+        numGraph = 0;
+        numBlock = 0;
+        first = 0;
+        last = 0;
+    }
+
+    // Plan shard k of n over numDataset datasets, with g type graphs each and b blocks of samples per type graph
+    void set(int k, int n, unsigned s, int numDataset, int g, int b)
+    {
+        index = k;
+        count = n;
+        seed = s;
+        numGraph = g;
+        numBlock = b;
+        long long numUnit = (long long)numDataset * numGraph * numBlock;
+        first = numUnit * k / n;
+        last = numUnit * (k + 1) / n;
+    }
+
+    long long unit(int dataset, int graph, int block) const
+    {
+        return ((long long)dataset * numGraph + graph) * numBlock + block;
+    }
+
+    bool owns(int dataset, int graph, int block) const
+    {
+        long long u = unit(dataset, graph, block);
+        return u >= first && u < last;
+    }
+
+    // Whether any block of a type graph belongs to this shard
+    bool owns_graph(int dataset, int graph) const
+    {
+        return unit(dataset, graph, 0) < last && unit(dataset, graph, numBlock) > first;
+    }
+
+    // Seed rng for loading and preprocessing a type graph, and for a block of samples of it
+    void seed_graph(int dataset, int graph) const
+    {
+        seed_seq seq{seed, (unsigned)dataset, (unsigned)graph};
+        rng.seed(seq);
+    }
+
+    void seed_block(int dataset, int graph, int block) const
+    {
+        seed_seq seq{seed, (unsigned)dataset, (unsigned)graph, (unsigned)block};
+        rng.seed(seq);
+    }
+};
+
+// Partial file of results of shard k in directory
+string shard_file(const string &directory, int k)
+{
+    return directory + "/" + "resShard" + to_string(k) + ".txt";
+}
+
+// Run work(k) for k = 0, ..., n - 1 in n child processes, and return whether all of them returned 0
+// Without fork (not Linux), the shards run one after another in this process
+bool run_workers(int n, function<int(int)> work)
+{
+    bool success = true;
+#ifdef __linux__
+    cout.flush();
+    cerr.flush();
+    vector<pid_t> children;
+    for (int k = 0; k < n; k++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            int code = work(k);
+            cout.flush();
+            cerr.flush();
+            _exit(code);
+        }
+        if (pid < 0)
+        {
+            cerr << "Cannot start worker " << k << endl;
+            success = false;
+            break;
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children)
+    {
+        int status = 0;
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            success = false;
+    }
+#else
+    for (int k = 0; k < n; k++)
+        success &= (work(k) == 0);
+#endif
+    return success;
+}
@@ -1,27 +1,6 @@
 // Main program 
 
-#include <vector>
-#include <iostream>
-#include <iomanip>
-#include <fstream>
-#include <random>
-#include <queue>
-#include <map>
-#include <string>
-#include <algorithm>
-#include <set>
-#include "glpk.h" // For Brubach et al. (2016)
-
-using namespace std;
-mt19937 rng(random_device{}());
-
-#include "graph.h"
-#include "flow_graph.h"
-#include "cycle_break_graph.h"
-#include "decomposite_graph.h"
-#include "natural_lp.h"
-#include "read_file.cpp"
-#include "algorithms/algorithms.h"
+#include "stochastic_matching_library.h"
 
 // Return size of matching
 // -1 represents for not matched
@@ -59,46 +38,132 @@ pair<double, double> compute_mean_std(const vector<double> &res, bool average =
 }
 
 
+// Number of standard errors in confidence intervals, for 95% confidence
+const double confidenceZ = 1.96;
+
 //Store the results
 struct resAlg
 {
     // Algorithm name
     string name;
     
-    // Results of runs on one type graph (sampling online vertices)
-    vector<double> resRun;
+    // Results of runs on one type graph (sampling online vertices), paired with OPT of the same realization
+    // Accumulated without storing them, in groups of correlated realizations and with a control variate if enabled
+    ratio_stat resRun;
     
     // Results of runs on one dataset (sampling type graphs)
     vector<pair<double, double>> resSample;
     
     // Results of runs on all datasets
     vector<pair<double, double>> resDataset;
+    
+    // Half-width of confidence interval of ratio to OPT, and number of runs, on each type graph and each dataset
+    vector<pair<double, long long>> precSample, precDataset;
+    
+    // Estimated variance reduction factor of ratio to OPT, on each type graph and each dataset
+    vector<double> vrfSample, vrfDataset;
+    
+    // Time spent in runs over all datasets
+    timing_stat timing;
+    
+    // Hardware events in runs over all datasets, if counters are enabled
+    perf_stat perf;
+    
+    // Memory allocated in runs over all datasets
+    memory_stat memory;
 
     resAlg(string s)
     {
         name = s;
-        resRun = {};
+        resRun.clear();
         resSample = {};
         resDataset = {};
+        precSample = {};
+        precDataset = {};
+        vrfSample = {};
+        vrfDataset = {};
+        timing = timing_stat(s);
     }
     
-    // Add result of one run
-    void add_run(double item)
+    // Start runs on a type graph, with groups of groupSize correlated realizations and an optional control variate
+    void start_run(int groupSize = 1, bool useControl = false, double controlMean = 0)
     {
-        resRun.push_back(item);
+        resRun = ratio_stat(groupSize, useControl, controlMean);
     }
     
-    // Summarize runs on one type graph (sampling online vertices)
-    void summary_run(double base = 1)
+    // Add result of one run, with OPT and control variate of the same realization
+    void add_run(double item, double opt, double control = 0)
     {
-        auto mean_std = compute_mean_std(resRun);
-        resSample.push_back(make_pair(mean_std.first / base, mean_std.second / base));
+        resRun.add(item, opt, control);
+    }
+    
+    // Add results of runs accumulated elsewhere, e.g. by another thread
+    void merge_run(const ratio_stat &runs)
+    {
+        resRun.merge(runs);
+    }
+    
+    // Half-width of confidence interval of ratio to OPT on the current type graph
+    double half_width() const
+    {
+        return resRun.half_width(confidenceZ);
+    }
+    
+    // Write and read all results for checkpoints
+    void save(ostream &out) const
+    {
+        resRun.save(out);
+        put(out, resSample);
+        put(out, resDataset);
+        put(out, precSample);
+        put(out, precDataset);
+        put(out, vrfSample);
+        put(out, vrfDataset);
+        timing.save(out);
+        perf.save(out);
+        memory.save(out);
+    }
+    
+    void load(istream &in)
+    {
+        resRun.load(in);
+        get(in, resSample);
+        get(in, resDataset);
+        get(in, precSample);
+        get(in, precDataset);
+        get(in, vrfSample);
+        get(in, vrfDataset);
+        timing.load(in);
+        perf.load(in);
+        memory.load(in);
+    }
+    
+    // Summarize runs on one type graph (sampling online vertices), normalized by OPT of the same realizations
+    void summary_run()
+    {
+        double base = resRun.single.y.mean;
+        resSample.push_back(make_pair(resRun.ratio(), resRun.single.x.std_dev() / base));
+        precSample.push_back(make_pair(half_width(), resRun.count()));
+        vrfSample.push_back(resRun.reduction());
         resRun.clear();
     }
 
     // Summarize runs on one dataset (sampling type graphs)
+    // Precision of a dataset is the widest interval over its type graphs
     void summary_sample(bool stochastic = true)
     {
+        pair<double, long long> prec(0, 0);
+        for (auto item : precSample)
+            prec = make_pair(max(prec.first, item.first), prec.second + item.second);
+        precDataset.push_back(prec);
+        precSample.clear();
+        
+        double vrf = 0;
+        for (auto item : vrfSample)
+            vrf += item / vrfSample.size();
+        vrfDataset.push_back(vrf);
+        vrfSample.clear();
+        
         if (resSample.size() == 1)
         {
             resDataset.push_back(resSample[0]);
@@ -121,6 +186,7 @@ struct resAlg
     balanceSWOR("Balance-SWOR"),
     balanceOCS("Balance-OCS"),
     minDegree("MinDegree"),
+    minDegreeRandom("MinDegreeRandomTie"),
     feldmanMMM("FeldManEtAl"),
     bahmaniKapralov("BahmaniKapralov"),
     heaupler("HeauplerEtAl"),
@@ -133,7 +199,7 @@ struct resAlg
     poissonOCS("PoissonOCS");   //All algorithms
 
 
-//Presentation order in output
+//Presentation order in output, of all algorithms but MinDegreeRandomTie, which runs only if selected
 vector<resAlg*> resPointer = {
     &OPT,
     &regGreedy,
@@ -154,13 +220,105 @@ vector<resAlg*> resPointer = {
     &feldmanMMM
 };
 
+
+// Online algorithm with the preprocessing stages it needs
+// It runs on a workspace
+struct algorithm_entry
+{
+    resAlg *res;
+    unsigned needs;
+    function<const vector<int> &(graph &, preprocessing &, workspace &)> run;
+};
+
+//Registry of all algorithms, in the order they run
+vector<algorithm_entry> registry = {
+    {&stochasticSWOR, stage_bit(stageEdgeProb),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.sampling_without_replacement(ws, p.edgeProb); }},
+    {&regGreedy, stage_bit(stageEdgeProb),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.regularized_greedy(ws, p.edgeProb); }},
+    {&poissonOCS, stage_bit(stageEdgeProb),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.poisson_ocs(ws, p.offMass, p.edgeProb, p.poissonWeight, p.poissonSteps); }},
+    {&topHalf, stage_bit(stageEdgeProb),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.top_half_sampling(ws, p.edgeProb); }},
+    {&correlated, stage_bit(stageEdgeProb),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.correlated_sampling(ws, p.edgeProb); }},
+    {&ranking, 0,
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.ranking(ws); }},
+    {&balanceSWOR, 0,
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.balance_swor(ws); }},
+    {&balanceOCS, 0,
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.balance_ocs(ws); }},
+    {&minDegree, 0,
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.min_degree(ws); }},
+    {&minDegreeRandom, 0,
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.min_degree(ws, true); }},
+    {&manshadiGS, stage_bit(stageTypeProb),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.manshadi_et_al(ws, p.typeEdgeProb); }},
+    {&jailletLuNonInt, stage_bit(stageJailletLuNonInt),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.manshadi_et_al(ws, p.jlEdgeProb); }},
+    {&brubachSSX, stage_bit(stageBrubachTable),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.brubach_et_al(ws, p.brubachTable); }},
+    {&feldmanMMM, stage_bit(stageFeldmanColor),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.feldman_et_al(ws, p.blueF, p.redF); }},
+    {&bahmaniKapralov, stage_bit(stageBahmaniColor),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.bahmani_kapralov(ws, p.blueB, p.redB); }},
+    {&heaupler, stage_bit(stageHaeuplerAdvice),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.haeupler_et_al(ws, p.heauplerM1, p.heauplerM2, p.heauplerM3); }},
+    {&jailletLu, stage_bit(stageJailletLuTable),
+        [](graph &g, preprocessing &p, workspace &ws) -> const vector<int> & { return g.jaillet_lu(ws, p.jlTable); }}
+};
+
+// Return whether an algorithm is selected, i.e. in the output
+bool is_selected(const algorithm_entry &alg)
+{
+    return find(resPointer.begin(), resPointer.end(), alg.res) != resPointer.end();
+}
+
+// Select algorithms by name, in the order of output rows; exit on an unknown name
+void select_algorithms(const vector<string> &names)
+{
+    resPointer = {&OPT};
+    for (auto &name : names)
+    {
+        bool found = false;
+        for (auto &alg : registry)
+            if (alg.res->name == name)
+            {
+                resPointer.push_back(alg.res);
+                found = true;
+            }
+        if (!found)
+        {
+            cerr << "Unknown algorithm: " << name << endl;
+            exit(1);
+        }
+    }
+}
+
 vector <string> datasetName;
 
+// Number of threads computing preprocessing stages, 0 for all hardware threads
+int preprocessThreads = 0;
+
+// Relabelling of type graphs after they are loaded, see vertex_order.h
+reorder_mode vertexReorder = reorderNone;
+
+// Adaptive sample count: runs stop for an algorithm once the half-width of confidence interval of its ratio
+// to OPT is at most targetHalfWidth, checked every blockSize samples; 0 for a fixed number of samples
+double targetHalfWidth = 0;
+int blockSize = 1024;
+
+// Variance reduction: sampling of realizations, realizations in a Latin hypercube block,
+// and whether the number of distinct online types is used as a control variate
+sampling_mode samplingMode = samplingIid;
+int strata = 16;
+bool useControl = false;
+
 // Save results to directory
 void save_results_to_files(string directory)
 {
     ofstream fileResMean, fileResStd;
-    cout << "Save results into file " << directory + "/" + "(resMean.txt,resStd.txt)" << endl;
+    cout << "Save results into file " << directory + "/" + "(resMean.txt,resStd.txt,resPrecision.txt,resVRF.txt,resTiming.json,resTiming.csv" << (memoryTracking ? ",resMemory.csv" : "") << (perfEnabled ? ",resCounters.csv" : "") << ")" << endl;
     fileResMean.open(directory + "/" + "resMean.txt");
     fileResStd.open(directory + "/" + "resStd.txt");
     
@@ -195,213 +353,865 @@ void save_results_to_files(string directory)
         }
     fileResMean.close();
     fileResStd.close();
+    
+    // Precision as half-width of confidence interval of ratio to OPT, with number of runs in parentheses
+    ofstream fileResPrec(directory + "/" + "resPrecision.txt");
+    fileResPrec << fixed << setprecision(4);
+    fileResPrec << "Algorithm";
+    for (auto item : datasetName)
+        fileResPrec << " " << item;
+    fileResPrec << endl;
+    for (auto i : resPointer)
+        if (i != &OPT)
+        {
+            fileResPrec << (*i).name;
+            for (auto j : (*i).precDataset)
+                fileResPrec << " " << j.first << "(" << j.second << ")";
+            fileResPrec << endl;
+        }
+    fileResPrec.close();
+    
+    // Variance reduction factor of ratio to OPT, relative to independent samples
+    ofstream fileResVrf(directory + "/" + "resVRF.txt");
+    fileResVrf << fixed << setprecision(3);
+    fileResVrf << "Algorithm";
+    for (auto item : datasetName)
+        fileResVrf << " " << item;
+    fileResVrf << endl;
+    for (auto i : resPointer)
+        if (i != &OPT)
+        {
+            fileResVrf << (*i).name;
+            for (auto j : (*i).vrfDataset)
+                fileResVrf << " " << j;
+            fileResVrf << endl;
+        }
+    fileResVrf.close();
+    
+    // Time spent in algorithms and preprocessing stages
+    vector<const timing_stat *> algTiming, stages;
+    for (auto i : resPointer)
+        algTiming.push_back(&(*i).timing);
+    for (auto &t : stageTiming)
+        if (t.calls > 0)
+            stages.push_back(&t);
+    save_timing(algTiming, stages, directory + "/" + "resTiming.json", directory + "/" + "resTiming.csv");
+    
+    // Memory allocated by algorithms and preprocessing stages, if counted in this build
+    if (memoryTracking)
+    {
+        vector<pair<string, const memory_stat *>> memoryRows;
+        for (auto i : resPointer)
+            memoryRows.push_back(make_pair("algorithm," + (*i).name, &(*i).memory));
+        for (int s = 0; s < numStage; s++)
+            if (stageMemory[s].calls > 0)
+                memoryRows.push_back(make_pair("stage," + string(stageName[s]), &stageMemory[s]));
+        save_memory(memoryRows, directory + "/" + "resMemory.csv");
+    }
+    
+    if (perfEnabled)
+    {
+        vector<pair<string, const perf_stat *>> rows;
+        for (auto i : resPointer)
+            rows.push_back(make_pair("algorithm," + (*i).name, &(*i).perf));
+        for (int s = 0; s < numStage; s++)
+            if (stagePerf[s].calls > 0)
+                rows.push_back(make_pair("stage," + string(stageName[s]), &stagePerf[s]));
+        save_counters(rows, directory + "/" + "resCounters.csv");
+    }
 
     cout << "Output Results Done!" << endl;
 }
 
-// Apply numSample runs of all algorithms on a type graph (sampling online vertices)
-// Algorithms may use natural LP solution as parameter, or matching probability matrix simulated by Monte-Carlo
-// Extremely slow to compute natural LP, so only set useNatural to true for small graphs
-void run_on_graph(graph &g, int numSample, bool useNatural = false)
+// Clear results, timings and counters of all algorithms and stages, before a repetition of the experiment
+void clear_results()
 {
-    // Preprocessing
-    int realSize = g.online_size();
+    for (auto i : resPointer)
+        *i = resAlg((*i).name);
+    stageTiming = vector<timing_stat>(stageName, stageName + numStage);
+    stagePerf.assign(numStage, perf_stat());
+    stageMemory.assign(numStage, memory_stat());
+    datasetName.clear();
+}
+
+// Add metrics of one repetition of the experiment, in the order of output rows
+// Throughput and latency of algorithms, time and memory of stages, peak memory, and ratio to OPT on each dataset
+void record_metrics(regression_record &record)
+{
+    for (auto i : resPointer)
+    {
+        const timing_stat &t = (*i).timing;
+        record.metric("algorithm/" + (*i).name + "/realizationsPerSecond", true).values.push_back(t.wall > 0 ? t.calls / t.wall : 0);
+        record.metric("algorithm/" + (*i).name + "/latencyP50Micros").values.push_back(t.latency.percentile(0.5) * 1e6);
+        record.metric("algorithm/" + (*i).name + "/latencyP99Micros").values.push_back(t.latency.percentile(0.99) * 1e6);
+    }
+    for (int s = 0; s < numStage; s++)
+        if (stageTiming[s].calls > 0)
+        {
+            record.metric("stage/" + stageTiming[s].name + "/seconds").values.push_back(stageTiming[s].wall);
+            if (memoryTracking)
+                record.metric("stage/" + stageTiming[s].name + "/peakLiveBytes").values.push_back(stageMemory[s].peak);
+        }
+    if (peak_memory_kb() > 0)
+        record.metric("process/peakMemoryKB").values.push_back(peak_memory_kb());
+
+    for (auto i : resPointer)
+        if (i != &OPT)
+            for (int d = 0; d < (int)datasetName.size(); d++)
+            {
+                regression_metric &m = record.metric("ratio/" + (*i).name + "/" + datasetName[d], true, true);
+                m.values.push_back((*i).resDataset[d].first);
+                m.halfWidth.push_back((*i).precDataset[d].first);
+            }
+}
+
+// Metrics of repetitions of the experiment, for baselines
+regression_record experimentMetrics;
+
+// Checkpoint of the experiment, written to checkpointPath at the end of a type graph or of a block of samples,
+// at least checkpointInterval seconds after the previous one; a run started with a checkpoint resumes from it
+string checkpointPath = "";
+double checkpointInterval = 300, lastCheckpoint = 0;
+
+// Options of the experiment, which a resumed run must have the same
+string experimentFingerprint = "";
+
+// Unit of work of the experiment: repetition, dataset, type graph of the dataset and sample of the type graph
+// A position is the next unit to do, e.g. graph = numGraph when all type graphs of a dataset are done
+struct experiment_position
+{
+    int rep, dataset, graph, sample;
+};
+
+// Position of the current unit, and of the checkpoint while the run is resuming from it
+experiment_position currentPosition = {0, 0, 0, 0}, resumePosition = {0, 0, 0, 0};
+bool resuming = false;
+
+// State inside a type graph: rng at its start and at the checkpoint, generators of workspaces of its algorithms,
+// and whether each of them still runs
+struct graph_state
+{
+    mt19937 start, current;
+    vector<mt19937> gen;
+    vector<int> active;
+};
+graph_state resumeGraph;
+
+// Write a checkpoint if the previous one is old enough, with the state of the current type graph if inside one
+void save_checkpoint(const graph_state *inGraph = nullptr)
+{
+    if (checkpointPath.empty() || wall_time() - lastCheckpoint < checkpointInterval)
+        return;
     
-    map<pair<int, int>, double> typeProb  = g.optimal_matching_prob(numSample, realSize);
+    write_checkpoint_file(checkpointPath, [&](ostream &out)
+    {
+        put(out, experimentFingerprint);
+        put(out, currentPosition.rep);
+        put(out, currentPosition.dataset);
+        put(out, currentPosition.graph);
+        put(out, currentPosition.sample);
+        if (inGraph)
+        {
+            put(out, inGraph->start);
+            put(out, inGraph->current);
+            put(out, inGraph->gen);
+            put(out, inGraph->active);
+        }
+        else
+            put(out, rng);
+        
+        put(out, datasetName);
+        for (auto i : resPointer)
+            (*i).save(out);
+        for (int s = 0; s < numStage; s++)
+        {
+            stageTiming[s].save(out);
+            stagePerf[s].save(out);
+            stageMemory[s].save(out);
+        }
+        experimentMetrics.save(out);
+    });
+    lastCheckpoint = wall_time();
+}
 
-    natural_lp lp(g.get_adj(),g.online_size());
-    map<pair<int, int>, double> naturalProb;
-    if (useNatural)
-        naturalProb = lp.solve_lp();
+// Resume from the checkpoint, if there is one; exit if it belongs to an experiment with other options
+void load_checkpoint()
+{
+    ifstream in(checkpointPath);
+    if (checkpointPath.empty() || !in)
+        return;
     
-    vector<double> offMass;
-    if (useNatural)
-        offMass = g.poisson_offline_mass(naturalProb);
+    string fingerprint;
+    get(in, fingerprint);
+    if (fingerprint != experimentFingerprint)
+    {
+        cerr << "Checkpoint " << checkpointPath << " belongs to an experiment with other options" << endl;
+        exit(1);
+    }
+    get(in, resumePosition.rep);
+    get(in, resumePosition.dataset);
+    get(in, resumePosition.graph);
+    get(in, resumePosition.sample);
+    if (resumePosition.sample > 0)
+    {
+        get(in, resumeGraph.start);
+        get(in, resumeGraph.current);
+        get(in, resumeGraph.gen);
+        get(in, resumeGraph.active);
+        rng = resumeGraph.start;
+    }
     else
-        offMass = g.poisson_offline_mass(typeProb);
+        get(in, rng);
+    
+    get(in, datasetName);
+    for (auto i : resPointer)
+        (*i).load(in);
+    for (int s = 0; s < numStage; s++)
+    {
+        stageTiming[s].load(in);
+        stagePerf[s].load(in);
+        stageMemory[s].load(in);
+    }
+    experimentMetrics.load(in);
     
+    if (!in)
+    {
+        cerr << "Cannot read checkpoint " << checkpointPath << endl;
+        exit(1);
+    }
+    resuming = true;
+    lastCheckpoint = wall_time();
+    cerr << "Resume from checkpoint " << checkpointPath << ": repetition " << resumePosition.rep + 1 << ", dataset " << resumePosition.dataset + 1
+         << ", type graph " << resumePosition.graph + 1 << ", sample " << resumePosition.sample << endl;
+}
 
-    vector<int> blueF, redF;
-    tie(blueF, redF) = g.feldman_et_al_color();
+// Shard of a sharded experiment, and results of its units of work, each as its position and results of all algorithms
+shard_plan shard;
+ostringstream shardUnits;
+int numShardUnit = 0;
 
-    vector<int> blueB, redB;
-    tie(blueB, redB) = g.bahmani_kapralov_color();
-    
-    
-    vector<vector<int>> jlList = g.jaillet_lu_list();
-    map<pair<int, int>, double> jlProb = g.jaillet_lu_non_integral();
-    
-    map<pair<int, int>, double> brubachLp = g.brubach_et_al_lp();
-    vector<vector<pair<int, double>>> brubachSSXH = g.brubach_et_al_h(brubachLp);
+// Start a unit of work of the shard: block of samples of the current type graph, with its own generators
+void start_shard_unit(int block, vector<fused_algorithm> &algs, int groupSize = 1, double controlMean = 0)
+{
+    shard.seed_block(currentPosition.dataset, currentPosition.graph, block);
+    for (auto &alg : algs)
+        alg.ws.gen.seed(rng());
+    for (auto i : resPointer)
+        (*i).start_run(groupSize, useControl, controlMean);
+}
+
+// Add results of the latest unit of work to the partial results of the shard
+void save_shard_unit(int block)
+{
+    put(shardUnits, currentPosition.dataset);
+    put(shardUnits, currentPosition.graph);
+    put(shardUnits, block);
+    for (auto i : resPointer)
+        (*i).resRun.save(shardUnits);
+    numShardUnit++;
+}
+
+// Apply numSample runs of selected algorithms on a type graph (sampling online vertices)
+// In adaptive mode numSample is the maximum, and each algorithm stops once its ratio to OPT is precise enough
+// Algorithms may use natural LP solution as parameter, or matching probability matrix simulated by Monte-Carlo
+// Extremely slow to compute natural LP, so only set useNatural to true for small graphs
+// Weights of Poisson OCS are interpolated from poissonSteps time steps, or computed exactly if it is 0
+void run_on_graph(graph &g, int numSample, bool useNatural = false, int poissonSteps = 0)
+{
+    // Preprocessing, only the stages needed by selected algorithms, independent stages in parallel
+    // On resuming inside this graph, preprocessing is computed again from the same rng
+    int realSize = g.online_size();
+    graph_state state;
+    state.start = rng;
     
-    vector<int> heauplerM1, heauplerM2;
-    vector<pair<int, int>> heauplerM3;
-    tie(heauplerM1, heauplerM2, heauplerM3) = g.haeupler_et_al_advice(brubachLp);
+    preprocessing pre(g, numSample, useNatural, poissonSteps);
+    unsigned needs = 0;
+    for (auto &alg : registry)
+        if (is_selected(alg))
+            needs |= alg.needs;
+    bool prepared = (preprocessThreads > 0) ? pre.prepare(needs, preprocessThreads) : pre.prepare(needs);
+    if (!prepared)
+    {
+        cerr << "Preprocessing exceeded the memory budget, experiment aborted" << endl;
+        exit(3);
+    }
 
-    for (int i = 0; i < numSample; i++)
+    // Online algorithms advance together over each realization, each with its own workspace
+    vector<fused_algorithm> algs;
+    vector<resAlg*> algRes;
+    for (auto &alg : registry)
+        if (is_selected(alg))
+        {
+            auto run = alg.run;
+            algs.push_back(fused_algorithm([&g, &pre, run](workspace &ws) -> const vector<int> & { return run(g, pre, ws); }));
+            algRes.push_back(alg.res);
+        }
+
+    // Numbers of samples are rounded up to whole groups of correlated realizations
+    realization_sampler sampler(g, samplingMode, strata);
+    int group = sampler.group_size();
+    numSample = (numSample + group - 1) / group * group;
+    int block = (blockSize + group - 1) / group * group;
+    workspace ws;
+    int first = 0;
+    if (resuming)
     {
-        g.realize(realSize);
+        // Results so far are restored from the checkpoint, and the state of algorithms at its block
+        first = resumePosition.sample;
+        rng = resumeGraph.current;
+        for (int k = 0; k < (int)algs.size(); k++)
+        {
+            algs[k].ws.gen = resumeGraph.gen[k];
+            algs[k].active = resumeGraph.active[k];
+        }
+        resuming = false;
+    }
+    else
+        for (auto i : resPointer)
+            (*i).start_run(group, useControl, sampler.control_mean());
+
+    for (int i = first; i < numSample; i++)
+    {
+        // In a sharded experiment, blocks of samples of other shards are skipped
+        if (shard.count > 0 && i % block == 0)
+        {
+            if (!shard.owns(currentPosition.dataset, currentPosition.graph, i / block))
+            {
+                i += block - 1;
+                continue;
+            }
+            start_shard_unit(i / block, algs, group, sampler.control_mean());
+        }
         
-        OPT.add_run(match_size(g.maximum_matching()));
+        sampler.realize(g);
+        int control = useControl ? sampler.control() : 0;
         
-        if (useNatural)
+        int opt;
         {
-            stochasticSWOR.add_run(match_size(g.sampling_without_replacement(naturalProb)));
-            regGreedy.add_run(match_size(g.regularized_greedy(naturalProb)));
-            poissonOCS.add_run(match_size(g.poisson_ocs(offMass, naturalProb)));
-            topHalf.add_run(match_size(g.top_half_sampling(naturalProb)));
-            correlated.add_run(match_size(g.correlated_sampling(naturalProb)));
+            perf_scope counters(OPT.perf);
+            memory_scope allocated(OPT.memory);
+            double start = wall_time();
+            opt = match_size(g.maximum_matching(ws));
+            OPT.timing.add(wall_time() - start, realSize);
         }
-        else
+        OPT.add_run(opt, opt, control);
+        
+        fused_run(g, algs);
+        for (int k = 0; k < (int)algs.size(); k++)
+            if (algs[k].active)
+            {
+                algRes[k]->add_run(match_size(algs[k].ws.res), opt, control);
+                algRes[k]->timing.add(algs[k].elapsed, realSize);
+            }
+        
+        // In adaptive mode, algorithms whose ratio to OPT is precise enough stop at the end of each block
+        if (targetHalfWidth > 0 && (i + 1) % block == 0)
         {
-            stochasticSWOR.add_run(match_size(g.sampling_without_replacement(typeProb)));
-            regGreedy.add_run(match_size(g.regularized_greedy(typeProb)));
-            poissonOCS.add_run(match_size(g.poisson_ocs(offMass, typeProb)));
-            topHalf.add_run(match_size(g.top_half_sampling(typeProb)));
-            correlated.add_run(match_size(g.correlated_sampling(typeProb)));
+            bool running = false;
+            for (int k = 0; k < (int)algs.size(); k++)
+            {
+                if (algRes[k]->half_width() <= targetHalfWidth)
+                    algs[k].active = false;
+                running |= algs[k].active;
+            }
+            
+            if (!running)
+                break;
         }
         
-        ranking.add_run(match_size(g.ranking()));
-        balanceSWOR.add_run(match_size(g.balance_swor()));
-        balanceOCS.add_run(match_size(g.balance_ocs()));
-        minDegree.add_run(match_size(g.min_degree()));
+        // Checkpoint at the end of a block
+        if ((i + 1) % block == 0 && !checkpointPath.empty())
+        {
+            currentPosition.sample = i + 1;
+            state.current = rng;
+            state.gen.clear();
+            state.active.clear();
+            for (auto &alg : algs)
+            {
+                state.gen.push_back(alg.ws.gen);
+                state.active.push_back(alg.active);
+            }
+            save_checkpoint(&state);
+            currentPosition.sample = 0;
+        }
         
-        feldmanMMM.add_run(match_size(g.feldman_et_al(blueF, redF)));
-        bahmaniKapralov.add_run(match_size(g.bahmani_kapralov(blueB, redB)));
-        heaupler.add_run(match_size(g.haeupler_et_al(heauplerM1, heauplerM2, heauplerM3)));
-        manshadiGS.add_run(match_size(g.manshadi_et_al(typeProb)));
-        jailletLu.add_run(match_size(g.jaillet_lu(jlList)));
-        jailletLuNonInt.add_run(match_size(g.manshadi_et_al(jlProb)));
-        brubachSSX.add_run(match_size(g.brubach_et_al(brubachSSXH)));
+        if (shard.count > 0 && ((i + 1) % block == 0 || i == numSample - 1))
+            save_shard_unit(i / block);
     }
     
-    // Summarize runs on one type graph (sampling online vertices)
-    double opt = compute_mean_std(OPT.resRun).first;
-    for (auto i : resPointer)
-        (*i).summary_run(opt);
+    for (int k = 0; k < (int)algs.size(); k++)
+    {
+        algRes[k]->perf.merge(algs[k].perf);
+        algRes[k]->memory.merge(algs[k].memory);
+    }
+    
+    // Summarize runs on one type graph (sampling online vertices), done by the merge in a sharded experiment
+    if (shard.count == 0)
+        for (auto i : resPointer)
+            (*i).summary_run();
 }
 
-// Apply numSample runs of algorithms on a graph in online matching
-// Only four algorithms available in online matching: MinDegree, RANKING, Balance-OCS, Balance-SWOR
+// Apply numSample runs of selected algorithms on a graph in online matching
+// Only algorithms without preprocessing available in online matching: MinDegree, RANKING, Balance-OCS, Balance-SWOR
 void run_on_non_stochastic_graph(graph &g, int numSample)
 {
     // Preprocessing
     int realSize = g.online_size();
+    workspace ws;
     g.realize(realSize, false);
-    OPT.add_run(match_size(g.maximum_matching()));
+    for (auto i : resPointer)
+        (*i).start_run();
+    int opt = match_size(g.maximum_matching(ws));
+    OPT.add_run(opt, opt);
 
+    preprocessing pre(g, numSample, false, 0);
+    vector<fused_algorithm> algs;
+    vector<resAlg*> algRes;
+    for (auto &alg : registry)
+        if (is_selected(alg))
+        {
+            auto run = alg.run;
+            algs.push_back(fused_algorithm([&g, &pre, run](workspace &ws) -> const vector<int> & { return run(g, pre, ws); }));
+            algRes.push_back(alg.res);
+        }
+
+    // In a sharded experiment, each block of samples is a unit of work, and OPT is counted in the first one
     for (int i = 0; i < numSample; i++)
     {
-        ranking.add_run(match_size(g.ranking()));
-        balanceSWOR.add_run(match_size(g.balance_swor()));
-        balanceOCS.add_run(match_size(g.balance_ocs()));
-        minDegree.add_run(match_size(g.min_degree()));
+        if (shard.count > 0 && i % blockSize == 0)
+        {
+            if (!shard.owns(currentPosition.dataset, currentPosition.graph, i / blockSize))
+            {
+                i += blockSize - 1;
+                continue;
+            }
+            start_shard_unit(i / blockSize, algs);
+            if (i == 0)
+                OPT.add_run(opt, opt);
+        }
+        
+        fused_run(g, algs);
+        for (int k = 0; k < (int)algs.size(); k++)
+        {
+            algRes[k]->add_run(match_size(algs[k].ws.res), opt);
+            algRes[k]->timing.add(algs[k].elapsed, realSize);
+        }
+        
+        if (shard.count > 0 && ((i + 1) % blockSize == 0 || i == numSample - 1))
+            save_shard_unit(i / blockSize);
     }
     
-    // Summarize runs on one type graph (sampling online vertices)
-    double opt = compute_mean_std(OPT.resRun).first;
-    for (auto i : resPointer)
-        (*i).summary_run(opt);
+    for (int k = 0; k < (int)algs.size(); k++)
+    {
+        algRes[k]->perf.merge(algs[k].perf);
+        algRes[k]->memory.merge(algs[k].memory);
+    }
+    
+    // Summarize runs on one type graph (sampling online vertices), done by the merge in a sharded experiment
+    if (shard.count == 0)
+        for (auto i : resPointer)
+            (*i).summary_run();
 }
 
 
 // Run experiments on graphs generated from file
 // Extremely slow to compute natural LP, so only set useNatural to true for small graphs
-void work_from_file(string name, bool useNatural = false)
+void work_from_file(string name, int numGraph = 1, int numSample = 10000, bool useNatural = false, int poissonSteps = 0)
 {
         
     cerr << "Working on file " << name << endl;
 
-    int numGraph = 1;
-    int numSample = 10000;
-    
+    // The file is parsed once, and each type graph derived from it
+    dataset_source source(name, preprocessThreads, vertexReorder);
+
     cerr << "Rep";
-    for (int i = 1; i <= numGraph; i++)
+    for (int i = 0; i < numGraph; i++)
     {
-        cout << " " << i;
-        graph g = generate_from_file(name, true, 0);
-        run_on_graph(g, numSample, useNatural);
+        if (resuming && i < resumePosition.graph)
+            continue;
+        if (resuming && resumePosition.sample == 0)
+            resuming = false;
+        currentPosition.graph = i;
+        if (shard.count > 0)
+        {
+            if (!shard.owns_graph(currentPosition.dataset, i))
+                continue;
+            shard.seed_graph(currentPosition.dataset, i);
+        }
+        cout << " " << i + 1;
+        graph g = source.next();
+        run_on_graph(g, numSample, useNatural, poissonSteps);
+        currentPosition.graph = i + 1;
+        save_checkpoint();
     }
+    resuming = false;
     cerr << endl;
 
-    for (auto j : resPointer) (*j).summary_sample();
+    if (shard.count == 0)
+        for (auto j : resPointer) (*j).summary_sample();
 }
 
 // Run non-stochastic experiments on graphs generated from file
-void work_from_file_non_stochastic(string name, bool useNatural = false, bool stochastic = true)
+void work_from_file_non_stochastic(string name, int numGraph = 1000, int numSample = 100)
 {
         
     cerr << "Working on file " << name << endl;
 
-    int numGraph = 1000;
-    int numSample = 100;
-    resPointer = {&OPT, &balanceSWOR, &balanceOCS, &minDegree, &ranking};
+    // The file is parsed once, and each type graph derived from it
+    dataset_source source(name, preprocessThreads, vertexReorder);
 
     cerr << "Rep";
-    for (int i = 1; i <= numGraph; i++)
+    for (int i = 0; i < numGraph; i++)
     {
-        cout << " " << i;
-        graph g = generate_from_file(name, true, 0);
+        if (resuming && i < resumePosition.graph)
+            continue;
+        resuming = false;
+        currentPosition.graph = i;
+        if (shard.count > 0)
+        {
+            if (!shard.owns_graph(currentPosition.dataset, i))
+                continue;
+            shard.seed_graph(currentPosition.dataset, i);
+        }
+        cout << " " << i + 1;
+        graph g = source.next();
         run_on_non_stochastic_graph(g, numSample);
+        currentPosition.graph = i + 1;
+        save_checkpoint();
     }
+    resuming = false;
     cerr << endl;
 
-    for (auto j : resPointer) (*j).summary_sample(false);
+    if (shard.count == 0)
+        for (auto j : resPointer) (*j).summary_sample(false);
 }
 
-int main()
+// Do shard k of a sharded experiment, and write its partial results: units of work, then timings,
+// counters and memory of algorithms and stages
+int run_shard(const experiment_config &config, int k)
 {
-    // Work on real-world datasets in online stochastic matching
-    vector<pair<string, string>> file_name = 
+    clear_results();
+    shardUnits.str("");
+    numShardUnit = 0;
+    shard.set(k, shard.count, shard.seed, config.datasets.size(), shard.numGraph, shard.numBlock);
+    cerr << "Shard " << k + 1 << " of " << shard.count << ": units " << shard.first << " to " << shard.last - 1 << endl;
+    
+    for (int d = 0; d < (int)config.datasets.size(); d++)
+    {
+        currentPosition = {0, d, 0, 0};
+        if (shard.unit(d, 0, 0) >= shard.last || shard.unit(d + 1, 0, 0) <= shard.first)
+            continue;
+        if (config.stochastic)
+            work_from_file(config.datasets[d].first, config.graphs(), config.samples(), config.useNatural, config.poissonSteps);
+        else
+            work_from_file_non_stochastic(config.datasets[d].first, config.graphs(), config.samples());
+    }
+    
+    write_checkpoint_file(shard_file(config.output, k), [&](ostream &out)
+    {
+        put(out, config.fingerprint());
+        put(out, k);
+        put(out, shard.count);
+        put(out, numShardUnit);
+        out << shardUnits.str();
+        for (auto i : resPointer)
+        {
+            (*i).timing.save(out);
+            (*i).perf.save(out);
+            (*i).memory.save(out);
+        }
+        for (int s = 0; s < numStage; s++)
+        {
+            stageTiming[s].save(out);
+            stagePerf[s].save(out);
+            stageMemory[s].save(out);
+        }
+    });
+    return 0;
+}
+
+// Merge partial results of all shards in order of units into results of the experiment
+// Timings, counters and memory are added over shards; return false if a partial file is missing or belongs to another experiment
+bool merge_shards(const experiment_config &config)
+{
+    clear_results();
+    map<long long, vector<ratio_stat>> units;
+    for (int k = 0; k < shard.count; k++)
+    {
+        string path = shard_file(config.output, k);
+        ifstream in(path);
+        string fingerprint;
+        int index = -1, count = 0, numUnit = 0;
+        get(in, fingerprint);
+        get(in, index);
+        get(in, count);
+        get(in, numUnit);
+        if (!in || fingerprint != config.fingerprint() || index != k || count != shard.count)
+        {
+            cerr << "Partial results " << path << " are missing or belong to another experiment" << endl;
+            return false;
+        }
+        
+        for (int u = 0; u < numUnit; u++)
+        {
+            int d, i, b;
+            get(in, d);
+            get(in, i);
+            get(in, b);
+            vector<ratio_stat> &stats = units[shard.unit(d, i, b)];
+            stats.resize(resPointer.size());
+            for (auto &stat : stats)
+                stat.load(in);
+        }
+        for (auto i : resPointer)
+        {
+            timing_stat timing;
+            perf_stat perf;
+            memory_stat memory;
+            timing.load(in);
+            perf.load(in);
+            memory.load(in);
+            (*i).timing.merge(timing);
+            (*i).perf.merge(perf);
+            (*i).memory.merge(memory);
+        }
+        for (int s = 0; s < numStage; s++)
+        {
+            timing_stat timing;
+            perf_stat perf;
+            memory_stat memory;
+            timing.load(in);
+            perf.load(in);
+            memory.load(in);
+            stageTiming[s].merge(timing);
+            stagePerf[s].merge(perf);
+            stageMemory[s].merge(memory);
+        }
+        if (!in)
+        {
+            cerr << "Cannot read partial results " << path << endl;
+            return false;
+        }
+    }
+    
+    for (int d = 0; d < (int)config.datasets.size(); d++)
+    {
+        for (int i = 0; i < shard.numGraph; i++)
+        {
+            for (int b = 0; b < shard.numBlock; b++)
+            {
+                auto it = units.find(shard.unit(d, i, b));
+                if (it == units.end())
+                {
+                    cerr << "Partial results miss dataset " << d + 1 << ", type graph " << i + 1 << ", block " << b + 1 << endl;
+                    return false;
+                }
+                for (int r = 0; r < (int)resPointer.size(); r++)
+                    if (b == 0)
+                        resPointer[r]->resRun = it->second[r];
+                    else
+                        resPointer[r]->merge_run(it->second[r]);
+            }
+            for (auto j : resPointer)
+                (*j).summary_run();
+        }
+        for (auto j : resPointer)
+            (*j).summary_sample(config.stochastic);
+        datasetName.push_back(config.datasets[d].second);
+    }
+    return true;
+}
+
+// Run a sharded experiment: all shards in worker processes and the merge, one shard, or the merge alone
+// Shards need the same seed, drawn once before starting workers if not set
+int run_sharded(experiment_config &config)
+{
+    if (config.repetitions > 1 || config.targetHalfWidth > 0 || !config.checkpoint.empty() || !config.saveBaseline.empty() || !config.compareBaseline.empty())
+    {
+        cerr << "Sharded experiments do not support repetitions, targetHalfWidth, checkpoints or baselines" << endl;
+        return 1;
+    }
+    if (!config.hasSeed)
+    {
+        if (config.workers == 0)
+        {
+            cerr << "Shards of an experiment need the same seed" << endl;
+            return 1;
+        }
+        config.hasSeed = true;
+        config.seed = rng();
+    }
+    
+    // Blocks of samples of a type graph, rounded up to whole groups of correlated realizations as in run_on_graph
+    int numSample = config.samples(), block = config.blockSize;
+    if (config.stochastic)
     {
-        make_pair("real_world/socfb-Caltech36/socfb-Caltech36.txt", "Caltech36"),
-        make_pair("real_world/socfb-Reed98/socfb-Reed98.txt", "Reed98"),
-        make_pair("real_world/bio-CE-GN/bio-CE-GN.txt", "CE-GN"),
-        make_pair("real_world/bio-CE-PG/bio-CE-PG.txt", "CE-PG"),
-        make_pair("real_world/econ-beause/econ-beause.txt", "beause"),
-        make_pair("real_world/econ-mbeaflw/econ-mbeaflw.txt", "mbeaflw")
-    };
-    for (auto item : file_name)
+        int group = sampling_group_size(config.sampling, config.strata);
+        numSample = (numSample + group - 1) / group * group;
+        block = (block + group - 1) / group * group;
+    }
+    int numShard = config.workers > 0 ? config.workers : (config.shardCount > 0 ? config.shardCount : config.mergeCount);
+    shard.set(config.shardIndex, numShard, config.seed, config.datasets.size(), config.graphs(), (numSample + block - 1) / block);
+    
+    if (config.shardCount > 0)
+        return run_shard(config, config.shardIndex);
+    if (config.workers > 0 && !run_workers(config.workers, [&](int k) { return run_shard(config, k); }))
     {
-        work_from_file(item.first);
-        datasetName.push_back(item.second);
+        cerr << "A worker failed, results are not merged" << endl;
+        return 1;
     }
-    save_results_to_files("real_world_result");
-   
+    if (!merge_shards(config))
+        return 1;
+    save_results_to_files(config.output);
+    return 0;
+}
+
+// Usage: stochastic_matching_library [config file] [--option values ...], see experiment_config.h for options
+// Example config files are in configs, and without arguments the experiments of configs/real_world.cfg are run
+int main(int argc, char **argv)
+{
+    experiment_config config;
+    config.read_args(argc, argv);
     
+    // Work on real-world datasets in online stochastic matching
+    if (config.datasets.empty())
+        config.datasets = 
+        {
+            make_pair("real_world/socfb-Caltech36/socfb-Caltech36.txt", "Caltech36"),
+            make_pair("real_world/socfb-Reed98/socfb-Reed98.txt", "Reed98"),
+            make_pair("real_world/bio-CE-GN/bio-CE-GN.txt", "CE-GN"),
+            make_pair("real_world/bio-CE-PG/bio-CE-PG.txt", "CE-PG"),
+            make_pair("real_world/econ-beause/econ-beause.txt", "beause"),
+            make_pair("real_world/econ-mbeaflw/econ-mbeaflw.txt", "mbeaflw")
+        };
     
-    // Work on real-world small datasets in online stochastic matching
-    /*vector<pair<string, string>> file_name = 
+    if (config.hasSeed)
+        rng.seed(config.seed);
+    preprocessThreads = config.threads;
+    perfEnabled = config.perfCounters;
+    stageMemoryBudget = (long long)(config.memoryBudget * 1048576);
+    if (stageMemoryBudget > 0 && !memoryTracking)
     {
-        make_pair("real_world_small/soc-firm-hi-tech/soc-firm-hi-tech.txt", "hi-tech"),
-        make_pair("real_world_small/soc-physicians/soc-physicians.edges", "physicians"),
-        make_pair("real_world_small/gent113/gent113.mtx", "gent113"),
-        make_pair("real_world_small/lp_blend/lp_blend.mtx", "lp_blend")
-    };
-    for (auto item : file_name)
+        cerr << "memoryBudget needs a build with -DMEMORY_TRACKING" << endl;
+        return 1;
+    }
+    splitComponents = config.components;
+    compressTwins = config.twins;
+    vertexReorder = config.reorder;
+    if (perfEnabled)
+        check_perf_counters();
+    samplingMode = config.sampling;
+    strata = config.strata;
+    useControl = config.controlVariate;
+    targetHalfWidth = config.targetHalfWidth;
+    blockSize = config.blockSize;
+    
+    // Write synthetic datasets instead of running experiments
+    if (config.generate)
     {
-        work_from_file(item.first);
-        datasetName.push_back(item.second);
+        int numThread = config.threads > 0 ? config.threads : max(1u, thread::hardware_concurrency());
+        for (auto item : config.datasets)
+        {
+            synthetic_spec spec;
+            if (!spec.parse_path(item.first))
+                continue;
+            spec.seed = ((unsigned long long)rng() << 32) | rng();
+            cerr << "Write " << item.first << " into " << config.output << "/" << item.second << ".txt" << endl;
+            write_synthetic(spec, config.output + "/" + item.second + ".txt", numThread);
+        }
+        return 0;
     }
-    save_results_to_files("real_world_small_result");*/
     
+    // All algorithms by default, or the four without preprocessing in online matching
+    if (config.algorithms.empty())
+    {
+        if (config.stochastic)
+            for (auto i : resPointer)
+            {
+                if (i != &OPT)
+                    config.algorithms.push_back((*i).name);
+            }
+        else
+            config.algorithms = {"Balance-SWOR", "Balance-OCS", "MinDegree", "Ranking"};
+    }
+    select_algorithms(config.algorithms);
+    
+    if (!config.stochastic)
+        for (auto &alg : registry)
+            if (is_selected(alg) && alg.needs != 0)
+            {
+                cerr << "Algorithm " << alg.res->name << " is not available in online matching" << endl;
+                return 1;
+            }
+    
+    if (config.workers > 0 || config.shardCount > 0 || config.mergeCount > 0)
+        return run_sharded(config);
+    
+    checkpointPath = config.checkpoint;
+    checkpointInterval = config.checkpointInterval;
+    experimentFingerprint = config.fingerprint();
+    load_checkpoint();
+    
+    // Repetitions of the experiment give samples of each metric for baselines, results are saved from the first
+    // A resumed run skips the units of work done before its checkpoint
+    regression_record &record = experimentMetrics;
+    for (int rep = 0; rep < config.repetitions; rep++)
+    {
+        currentPosition = {rep, 0, 0, 0};
+        if (resuming && rep < resumePosition.rep)
+            continue;
+        if (resuming && resumePosition.dataset == 0 && resumePosition.graph == 0 && resumePosition.sample == 0)
+            resuming = false;
+        if (!resuming)
+        {
+            if (rep > 0)
+            {
+                clear_results();
+                if (config.hasSeed)
+                    rng.seed(config.seed + rep);
+                cerr << "Repetition " << rep + 1 << endl;
+            }
+            reset_peak_memory();
+        }
         
+        for (int d = 0; d < (int)config.datasets.size(); d++)
+        {
+            auto item = config.datasets[d];
+            currentPosition = {rep, d, 0, 0};
+            if (resuming && d < resumePosition.dataset)
+                continue;
+            if (config.stochastic)
+                work_from_file(item.first, config.graphs(), config.samples(), config.useNatural, config.poissonSteps);
+            else
+                work_from_file_non_stochastic(item.first, config.graphs(), config.samples());
+            datasetName.push_back(item.second);
+            currentPosition = {rep, d + 1, 0, 0};
+            save_checkpoint();
+        }
+        resuming = false;
+        if (rep == 0)
+            save_results_to_files(config.output);
+        record_metrics(record);
+        currentPosition = {rep + 1, 0, 0, 0};
+        save_checkpoint();
+    }
+    record.repetitions = config.repetitions;
     
-    // Work on real-world datasets in online matching
-    /*vector<pair<string, string>> file_name = 
+    // The experiment is complete, so its checkpoint is no longer needed
+    if (!checkpointPath.empty())
+        remove(checkpointPath.c_str());
+    
+    if (!config.saveBaseline.empty())
     {
-        make_pair("real_world/socfb-Caltech36/socfb-Caltech36.txt", "Caltech36"),
-        make_pair("real_world/socfb-Reed98/socfb-Reed98.txt", "Reed98"),
-        make_pair("real_world/bio-CE-GN/bio-CE-GN.txt", "CE-GN"),
-        make_pair("real_world/bio-CE-PG/bio-CE-PG.txt", "CE-PG"),
-        make_pair("real_world/econ-beause/econ-beause.txt", "beause"),
-        make_pair("real_world/econ-mbeaflw/econ-mbeaflw.txt", "mbeaflw")
-    };
-    for (auto item : file_name)
+        cout << "Save baseline into file " << config.saveBaseline << endl;
+        record.save(config.saveBaseline);
+    }
+    if (!config.compareBaseline.empty())
     {
-        work_from_file_non_stochastic(item.first, false);
-        datasetName.push_back(item.second);
+        regression_record base;
+        base.load(config.compareBaseline);
+        if (compare_with_baseline(record, base, config.regressionThreshold, config.qualityThreshold, config.output + "/" + "resRegression.csv"))
+            return 2;
     }
-    save_results_to_files("real_world_non_stochastic_result");*/
     return 0;
 }
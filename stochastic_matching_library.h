@@ -0,0 +1,58 @@
+// All components of the library, shared by the main program and the benchmark
+// The library is built as one translation unit, so this header is included once by each executable
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <random>
+#include <queue>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <set>
+#include <array>
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <chrono>
+#include <ctime>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "glpk.h" // For Brubach et al. (2016)
+
+using namespace std;
+// Each thread has its own generator, seeded by the task that runs on it
+thread_local mt19937 rng(random_device{}());
+
+#include "checkpoint.h"
+#include "permutation_table.h"
+#include "flow_graph.h"
+#include "workspace.h"
+#include "twin_classes.h"
+#include "graph.h"
+#include "cycle_break_graph.h"
+#include "decomposite_graph.h"
+#include "natural_lp.h"
+#include "graph_components.h"
+#include "vertex_order.h"
+#include "read_file.cpp"
+#include "synthetic_graph.h"
+#include "algorithms/algorithms.h"
+#include "profiler.h"
+#include "perf_counters.h"
+#include "memory_tracker.h"
+#include "fused_evaluator.h"
+#include "task_graph.h"
+#include "running_stat.h"
+#include "realization_sampler.h"
+#include "preprocessing.h"
+#include "experiment_config.h"
+#include "regression.h"
+#include "shard.h"
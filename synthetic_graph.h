@@ -0,0 +1,369 @@
+// Synthetic bipartite type graphs for scaling studies
+//   er:       Erdos-Renyi, every edge present independently with the same probability
+//   chung_lu: power-law expected degrees with exponent param (default 2.5) on both sides, by Chung and Lu
+//   planted:  a perfect matching of min(n, m) edges planted in Erdos-Renyi noise
+//   hub:      a fraction param (default 0.5) of edges on the 1% of offline vertices that are hubs, the rest Erdos-Renyi
+// Online types are generated in chunks, each by its own generator seeded by the seed and the chunk,
+// so a graph depends only on its spec and seed, not on the number of threads
+// Edges of a chunk are sampled by geometric skips (Miller and Hagberg for chung_lu), in time linear in its edges
+
+
+enum synthetic_model
+{
+    syntheticEr,
+    syntheticChungLu,
+    syntheticPlanted,
+    syntheticHub
+};
+
+const char *syntheticName[] = {"er", "chung_lu", "planted", "hub"};
+
+struct synthetic_spec{
+
+    synthetic_model model;
+
+    // Number of online types and offline vertices, and expected number of edges
+    int n, m;
+    long long edges;
+
+    // Power-law exponent of chung_lu, or fraction of edges on hubs
+    double param;
+
+    unsigned long long seed;
+
+    synthetic_spec()
+    {
+        model = syntheticEr;
+        n = m = 0;
+        edges = 0;
+        param = -1;
+        seed = 0;
+    }
+
+    // Parse "model n m edges [param]", and return whether it is valid
+    bool parse(const vector<string> &values)
+    {
+        if (values.size() != 4 && values.size() != 5)
+            return false;
+        int k = find(syntheticName, syntheticName + 4, values[0]) - syntheticName;
+        if (k == 4)
+            return false;
+        model = (synthetic_model)k;
+        n = stoi(values[1]);
+        m = stoi(values[2]);
+        edges = stoll(values[3]);
+        param = values.size() == 5 ? stod(values[4]) : -1;
+        if (param < 0)
+            param = (model == syntheticChungLu) ? 2.5 : 0.5;
+        return n > 0 && m > 0 && edges >= 0 && (model != syntheticChungLu || param > 2);
+    }
+
+    // Path of datasets, distinguished from files by the prefix "synthetic:"
+    string path() const
+    {
+        ostringstream sout;
+        sout << "synthetic:" << syntheticName[model] << ":" << n << ":" << m << ":" << edges << ":" << param;
+        return sout.str();
+    }
+
+    // Parse a path of datasets, and return whether it is a synthetic graph
+    bool parse_path(const string &s)
+    {
+        if (s.compare(0, 10, "synthetic:") != 0)
+            return false;
+        vector<string> values;
+        istringstream sin(s.substr(10));
+        string value;
+        while (getline(sin, value, ':'))
+            values.push_back(value);
+        return parse(values);
+    }
+};
+
+
+// Generator of offline neighbors of online types in chunks
+struct synthetic_generator{
+
+    static const int chunkSize = 4096;
+
+    synthetic_spec spec;
+
+    // Offline label of each generated offline vertex, random so that hubs and heavy vertices are spread over labels
+    vector<int> label;
+
+    // Offline vertex matched to each online type in planted
+    vector<int> planted;
+
+    // Chung-Lu weights of online types and offline vertices, with edge probability scale * wOn[i] * wOff[j]
+    vector<double> wOn, wOff;
+    double scale;
+
+    // Edge probability of Erdos-Renyi edges, and of edges to hubs
+    double p, pHub;
+    int numHub;
+
+    synthetic_generator(const synthetic_spec &s)
+    {
+        spec = s;
+        mt19937_64 gen(spec.seed);
+        double total = (double)spec.n * spec.m;
+
+        label.resize(spec.m);
+        iota(label.begin(), label.end(), 0);
+        if (spec.model == syntheticChungLu || spec.model == syntheticHub)
+            shuffle(label.begin(), label.end(), gen);
+
+        numHub = 0;
+        pHub = 0;
+        scale = 0;
+        p = min(1.0, spec.edges / total);
+        if (spec.model == syntheticPlanted)
+        {
+            int k = min(spec.n, spec.m);
+            planted.assign(spec.n, -1);
+            vector<int> perm(spec.m);
+            iota(perm.begin(), perm.end(), 0);
+            shuffle(perm.begin(), perm.end(), gen);
+            for (int i = 0; i < k; i++)
+                planted[i] = perm[i];
+            p = min(1.0, max(0.0, (double)(spec.edges - k)) / total);
+        }
+        else if (spec.model == syntheticHub)
+        {
+            numHub = max(1, spec.m / 100);
+            pHub = min(1.0, spec.param * spec.edges / ((double)spec.n * numHub));
+            p = spec.m > numHub ? min(1.0, (1 - spec.param) * spec.edges / ((double)spec.n * (spec.m - numHub))) : 0;
+        }
+        else if (spec.model == syntheticChungLu)
+        {
+            // Weight of rank r is (r + 1)^(-1 / (gamma - 1)), so that degrees follow a power law of exponent gamma
+            double alpha = 1 / (spec.param - 1), sumOn = 0, sumOff = 0;
+            wOn.resize(spec.n);
+            wOff.resize(spec.m);
+            for (int i = 0; i < spec.n; i++)
+                sumOn += (wOn[i] = pow(i + 1.0, -alpha));
+            for (int j = 0; j < spec.m; j++)
+                sumOff += (wOff[j] = pow(j + 1.0, -alpha));
+            scale = spec.edges / (sumOn * sumOff);
+        }
+    }
+
+    int num_chunk() const
+    {
+        return (spec.n + chunkSize - 1) / chunkSize;
+    }
+
+    // Append vertices in [lo, hi), each independently with probability q, by geometric skips
+    static void sample_range(int lo, int hi, double q, mt19937_64 &gen, vector<int> &out)
+    {
+        if (q <= 0)
+            return;
+        if (q >= 1)
+        {
+            for (int j = lo; j < hi; j++)
+                out.push_back(j);
+            return;
+        }
+        uniform_real_distribution<double> unit(0.0, 1.0);
+        double logq = log(1 - q);
+        for (double j = lo - 1.0;;)
+        {
+            j += 1 + floor(log(1 - unit(gen)) / logq);
+            if (j >= hi)
+                break;
+            out.push_back((int)j);
+        }
+    }
+
+    // Generate offline neighbors (labels in [0, m)) of online types in chunk c
+    void generate_chunk(int c, vector<vector<int>> &onAdj) const
+    {
+        seed_seq seq{(unsigned)spec.seed, (unsigned)(spec.seed >> 32), (unsigned)c};
+        mt19937_64 gen(seq);
+        uniform_real_distribution<double> unit(0.0, 1.0);
+        int lo = c * chunkSize, hi = min(spec.n, lo + chunkSize);
+
+        for (int i = lo; i < hi; i++)
+        {
+            vector<int> &row = onAdj[i];
+            row.clear();
+            if (spec.model == syntheticChungLu)
+            {
+                // Offline vertices in decreasing weight, skipping by the probability of the previous one
+                double q = min(1.0, scale * wOn[i] * wOff[0]);
+                for (int j = 0; j < spec.m && q > 0;)
+                {
+                    if (q < 1)
+                        j += (int)min((double)spec.m, floor(log(1 - unit(gen)) / log(1 - q)));
+                    if (j >= spec.m)
+                        break;
+                    double r = min(1.0, scale * wOn[i] * wOff[j]);
+                    if (unit(gen) < r / q)
+                        row.push_back(j);
+                    q = r;
+                    j++;
+                }
+            }
+            else
+            {
+                sample_range(numHub, spec.m, p, gen, row);
+                sample_range(0, numHub, pHub, gen, row);
+                if (spec.model == syntheticPlanted && planted[i] != -1 &&
+                    find(row.begin(), row.end(), planted[i]) == row.end())
+                    row.push_back(planted[i]);
+            }
+            for (int &j : row)
+                j = label[j];
+        }
+    }
+
+    // Generate chunks [first, last) with numThread threads
+    void generate(int first, int last, vector<vector<int>> &onAdj, int numThread) const
+    {
+        atomic<int> next(first);
+        auto work = [&]()
+        {
+            for (int c; (c = next++) < last;)
+                generate_chunk(c, onAdj);
+        };
+        vector<thread> workers;
+        for (int t = 1; t < numThread; t++)
+            workers.push_back(thread(work));
+        work();
+        for (auto &w : workers)
+            w.join();
+    }
+};
+
+
+// Generate a synthetic type graph in place of the graph's adjacency lists
+graph generate_synthetic(const synthetic_spec &spec, int numThread = max(1u, thread::hardware_concurrency()))
+{
+    synthetic_generator gen(spec);
+    vector<vector<int>> onAdj(spec.n);
+    gen.generate(0, gen.num_chunk(), onAdj, numThread);
+    for (auto &row : onAdj)
+        for (int &j : row)
+            j += spec.n;
+
+    graph g(spec.n, spec.m);
+    g.set_online_adj(onAdj);
+    return g;
+}
+
+// Write a synthetic type graph in the format of generate_from_file with dup, without storing the graph
+// The format has as many online types as offline vertices, so the smaller side is padded with isolated vertices
+void write_synthetic(const synthetic_spec &spec, string path, int numThread = max(1u, thread::hardware_concurrency()))
+{
+    synthetic_generator gen(spec);
+    ofstream fout(path, ios::binary);
+    fout << "% " << spec.path() << " seed " << spec.seed << "\n";
+
+    // Number of edges is known at the end, so it is written over a padded field
+    fout << "% ";
+    streampos countPos = fout.tellp();
+    fout << string(20, ' ') << " " << max(spec.n, spec.m) << "\n";
+
+    // Chunks are generated and formatted in parallel, in waves of a few chunks per thread
+    vector<vector<int>> onAdj(spec.n);
+    long long count = 0;
+    int wave = 4 * numThread;
+    for (int first = 0; first < gen.num_chunk(); first += wave)
+    {
+        int last = min(gen.num_chunk(), first + wave);
+        gen.generate(first, last, onAdj, numThread);
+
+        vector<string> text(last - first);
+        atomic<int> next(first);
+        auto work = [&]()
+        {
+            for (int c; (c = next++) < last;)
+            {
+                string &s = text[c - first];
+                char buf[32];
+                for (int i = c * synthetic_generator::chunkSize; i < min(spec.n, (c + 1) * synthetic_generator::chunkSize); i++)
+                {
+                    for (int j : onAdj[i])
+                        s.append(buf, snprintf(buf, sizeof(buf), "%d %d\n", i + 1, j + 1));
+                    vector<int>().swap(onAdj[i]);
+                }
+            }
+        };
+        vector<thread> workers;
+        for (int t = 1; t < numThread; t++)
+            workers.push_back(thread(work));
+        work();
+        for (auto &w : workers)
+            w.join();
+
+        for (auto &s : text)
+        {
+            count += count_if(s.begin(), s.end(), [](char ch) { return ch == '\n'; });
+            fout.write(s.data(), s.size());
+        }
+    }
+
+    fout.seekp(countPos);
+    fout << count;
+    fout.close();
+}
+
+// Type graphs of a dataset: a file is parsed once and each type graph is its bipartite copy,
+// and a synthetic type graph is generated again for each, seeded by rng
+// The bipartite copy draws no random numbers, so it is derived once and each type graph copies it
+// Synthetic graphs are generated by numThread threads, 0 for all hardware threads
+struct dataset_source{
+
+    bool synthetic;
+    synthetic_spec spec;
+    edge_list edges;
+    int numThread;
+
+    // Relabelling of each type graph, and the order of the last one, mapping it back to ids of the dataset
+    reorder_mode reorder;
+    vertex_order order;
+
+    // Type graph derived from the file, once
+    shared_ptr<graph> derived;
+
+    dataset_source(const string &path, int t = 0, reorder_mode r = reorderNone)
+    {
+        synthetic = spec.parse_path(path);
+        if (!synthetic)
+            edges = read_edge_list(path);
+        numThread = t > 0 ? t : max(1u, thread::hardware_concurrency());
+        reorder = r;
+    }
+
+    graph next()
+    {
+        if (synthetic)
+            return relabel(generate());
+        if (!derived)
+        {
+            derived = make_shared<graph>(relabel(dup_graph(edges)));
+            edges = edge_list();
+        }
+        return *derived;
+    }
+
+    graph relabel(graph g)
+    {
+        if (reorder == reorderNone)
+            return g;
+        order = vertex_order(g, reorder);
+        return order.apply(g);
+    }
+
+    graph generate()
+    {
+        spec.seed = ((unsigned long long)rng() << 32) | rng();
+        return generate_synthetic(spec, numThread);
+    }
+};
+
+// Type graph of a dataset, synthetic (seeded by rng) or read from file
+graph load_dataset(const string &path, int numThread = 0)
+{
+    return dataset_source(path, numThread).next();
+}
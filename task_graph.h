@@ -0,0 +1,79 @@
+// Tasks with dependencies, run concurrently by a pool of threads
+// A task starts once all tasks it depends on have finished, and ready tasks start in the order they were added
+
+
+struct task_graph{
+
+    // Work of each task
+    vector<function<void()>> work;
+
+    // Tasks that depend on each task
+    vector<vector<int>> dependents;
+
+    // Number of unfinished tasks that each task depends on
+    vector<int> pending;
+
+    task_graph()
+    {
+        work = {};
+        dependents = {};
+        pending = {};
+    }
+
+    // Add a task depending on tasks deps, added before, and return its index
+    int add_task(function<void()> f, const vector<int> &deps = {})
+    {
+        int id = work.size();
+        work.push_back(f);
+        dependents.push_back({});
+        pending.push_back(deps.size());
+        for (int d : deps)
+            dependents[d].push_back(id);
+        return id;
+    }
+
+    // Run all tasks on numThread threads, and return when all have finished
+    void run(int numThread)
+    {
+        int numTask = work.size();
+        if (numTask == 0)
+            return;
+
+        mutex lock;
+        condition_variable wake;
+        priority_queue<int, vector<int>, greater<int>> ready;
+        int finished = 0;
+        for (int i = 0; i < numTask; i++)
+            if (pending[i] == 0)
+                ready.push(i);
+
+        auto worker = [&]()
+        {
+            unique_lock<mutex> guard(lock);
+            while (true)
+            {
+                wake.wait(guard, [&]() { return !ready.empty() || finished == numTask; });
+                if (finished == numTask)
+                    return;
+
+                int i = ready.top();
+                ready.pop();
+                guard.unlock();
+                work[i]();
+                guard.lock();
+
+                finished++;
+                for (int j : dependents[i])
+                    if (--pending[j] == 0)
+                        ready.push(j);
+                wake.notify_all();
+            }
+        };
+
+        vector<thread> pool;
+        for (int k = 0; k < max(1, min(numThread, numTask)); k++)
+            pool.push_back(thread(worker));
+        for (auto &t : pool)
+            t.join();
+    }
+};
@@ -0,0 +1,101 @@
+// Twin classes of a type graph: online types with the same set of neighbors form a class, and so do offline vertices
+// Every online class is adjacent to every vertex of an offline class or to none, so the classes form a smaller
+// type graph in which each class stands for its multiplicity of vertices
+// An LP or fractional flow invariant under permuting twins has an optimal solution equal on twin edges, so it can be
+// solved on the classes, with constraints and capacities scaled by multiplicities, and expanded back to edges
+// Vertices with parallel edges are kept as classes of their own
+
+
+struct twin_classes{
+
+    // Numbers of online types and offline vertices of the graph
+    int onSize, offSize;
+
+    // Numbers of online and offline classes
+    int numOnline, numOffline;
+
+    // Class of each vertex, online classes first, labelled in order of their first vertex
+    vector<int> cls;
+
+    // Multiplicity of each class
+    vector<long long> mult;
+
+    // Neighbor classes of each class, in the order of neighbors of its first vertex
+    vector<vector<int>> adj;
+
+    twin_classes(const vector<vector<int>> &g, int n)
+    {
+        onSize = n;
+        offSize = g.size() - n;
+
+        // Vertices of a side sorted by their sets of neighbors, so that twins are consecutive
+        vector<vector<int>> key(g.size());
+        for (int v = 0; v < (int)g.size(); v++)
+        {
+            key[v] = g[v];
+            sort(key[v].begin(), key[v].end());
+        }
+        auto simple = [&](int v) { return adjacent_find(key[v].begin(), key[v].end()) == key[v].end(); };
+
+        vector<int> group(g.size());
+        for (int pass = 0; pass < 2; pass++)
+        {
+            vector<int> order;
+            for (int v = (pass ? onSize : 0); v < (pass ? (int)g.size() : onSize); v++)
+                order.push_back(v);
+            stable_sort(order.begin(), order.end(), [&](int a, int b) { return key[a] < key[b]; });
+            for (int k = 0; k < (int)order.size(); k++)
+            {
+                int v = order[k], u = k ? order[k - 1] : -1;
+                group[v] = (u != -1 && key[u] == key[v] && simple(v)) ? group[u] : v;
+            }
+        }
+        key.clear();
+
+        // Classes labelled in order of their first vertex, with the class graph built from it
+        cls.assign(g.size(), -1);
+        numOnline = numOffline = 0;
+        vector<int> first;
+        for (int v = 0; v < (int)g.size(); v++)
+        {
+            if (cls[group[v]] == -1)
+            {
+                cls[group[v]] = first.size();
+                first.push_back(v);
+                mult.push_back(0);
+                (v < onSize ? numOnline : numOffline)++;
+            }
+            cls[v] = cls[group[v]];
+            mult[cls[v]]++;
+        }
+
+        adj.resize(first.size());
+        vector<int> seen(first.size(), -1);
+        for (int c = 0; c < (int)first.size(); c++)
+            for (int u : g[first[c]])
+                if (seen[cls[u]] != c)
+                {
+                    seen[cls[u]] = c;
+                    adj[c].push_back(cls[u]);
+                }
+    }
+
+    // Whether some class has several vertices
+    bool compresses() const
+    {
+        return numOnline + numOffline < onSize + offSize;
+    }
+
+    // Value of each edge (i, j) of the graph, given the value of each class edge
+    map<pair<int, int>, double> expand(const vector<vector<int>> &g, const map<pair<int, int>, double> &classValue) const
+    {
+        map<pair<int, int>, double> out;
+        for (int i = 0; i < onSize; i++)
+            for (int j : g[i])
+            {
+                auto it = classValue.find(make_pair(cls[i], cls[j]));
+                out[make_pair(i, j)] = (it == classValue.end()) ? 0.0 : it->second;
+            }
+        return out;
+    }
+};
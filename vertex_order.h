@@ -0,0 +1,95 @@
+// Relabelling of a type graph for locality of the arrays indexed by vertices in online algorithms
+// Online types and offline vertices are renumbered separately, so a relabelled graph is a type graph like any other;
+// neighbors keep their order in each adjacency list, and ties broken by id use ids of the dataset (graph::id),
+// so algorithms see the same graph up to names
+// Preprocessing that depends on the order of vertices and edges, the maximum flows of Feldman et al., Bahmani and
+// Kapralov, Haeupler et al. and Jaillet and Lu, the LP of Brubach et al. and the rounding and cycle breaking of
+// cycle_break_graph, may find another optimal solution on a relabelled graph, so their results may change
+// The order keeps the ids of the dataset, to report vertices by them
+
+
+enum reorder_mode
+{
+    reorderNone,    // Ids of the dataset
+    reorderDegree,  // Decreasing degree on each side, so that hubs share cache lines
+    reorderBfs      // Breadth-first (Cuthill-McKee) order from a vertex of minimum degree in each component,
+                    // neighbors in increasing degree, so that neighbors of a type get close ids
+};
+
+
+struct vertex_order{
+
+    // Vertex of the dataset at each new id, online types first, and new id of each vertex of the dataset
+    vector<int> vertex, local;
+
+    // Number of online types
+    int numOnline;
+
+    vertex_order()
+    {
+        numOnline = 0;
+    }
+
+    vertex_order(graph &g, reorder_mode mode)
+    {
+        numOnline = g.online_size();
+        int n = numOnline + g.offline_size();
+        vector<vector<int>> adj = g.get_adj();
+        vector<int> degree(n);
+        for (int v = 0; v < n; v++)
+            degree[v] = adj[v].size();
+        auto by_degree = [&](int a, int b) { return degree[a] < degree[b]; };
+
+        vector<int> order(n);
+        iota(order.begin(), order.end(), 0);
+        if (mode == reorderDegree)
+            stable_sort(order.begin(), order.end(), [&](int a, int b) { return degree[a] > degree[b]; });
+        else if (mode == reorderBfs)
+        {
+            stable_sort(order.begin(), order.end(), by_degree);
+            vector<char> visited(n, false);
+            vector<int> que;
+            que.reserve(n);
+            for (int r : order)
+            {
+                if (visited[r])
+                    continue;
+                visited[r] = true;
+                que.push_back(r);
+                for (int head = (int)que.size() - 1; head < (int)que.size(); head++)
+                {
+                    int first = que.size();
+                    for (int u : adj[que[head]])
+                        if (!visited[u])
+                        {
+                            visited[u] = true;
+                            que.push_back(u);
+                        }
+                    stable_sort(que.begin() + first, que.end(), by_degree);
+                }
+            }
+            order.swap(que);
+        }
+
+        // Each side keeps the relative order of its vertices
+        vertex.clear();
+        for (int pass = 0; pass < 2; pass++)
+            for (int v : order)
+                if ((v < numOnline) == !pass)
+                    vertex.push_back(v);
+        local.assign(n, -1);
+        for (int k = 0; k < n; k++)
+            local[vertex[k]] = k;
+    }
+
+    // The graph relabelled by this order, keeping the ids in the dataset of its vertices
+    graph apply(graph &g) const
+    {
+        graph h = g.subgraph(vertex, numOnline, local);
+        vector<int> ids(vertex.size());
+        for (int k = 0; k < (int)vertex.size(); k++)
+            ids[k] = g.id(vertex[k]);
+        h.set_ids(ids);
+        return h;
+    }
+};
@@ -0,0 +1,164 @@
+// Scratch memory reused across runs of online algorithms
+// Keep one workspace per thread, so that repeated runs do no heap allocation in steady state
+
+
+// Flags over vertices, all cleared in O(1) by moving to a new epoch
+struct epoch_flags{
+
+    // Vertex j is flagged iff stamp[j] == epoch
+    vector<unsigned> stamp;
+    unsigned epoch;
+
+    epoch_flags()
+    {
+        stamp = {};
+        epoch = 0;
+    }
+
+    // Clear all flags over n vertices
+    void reset(int n)
+    {
+        if ((int)stamp.size() < n)
+            stamp.resize(n, 0);
+
+        // Stamps are only rewritten when the epoch counter wraps around
+        if (++epoch == 0)
+        {
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    bool test(int j) const
+    {
+        return stamp[j] == epoch;
+    }
+
+    void set(int j)
+    {
+        stamp[j] = epoch;
+    }
+};
+
+
+// Values over vertices, all reset to a default value in O(1) by moving to a new epoch
+template <class T>
+struct epoch_array{
+
+    // Value of vertex j is val[j] if stamp[j] == epoch, and init otherwise
+    vector<T> val;
+    vector<unsigned> stamp;
+    unsigned epoch;
+    T init;
+
+    epoch_array()
+    {
+        val = {};
+        stamp = {};
+        epoch = 0;
+        init = T();
+    }
+
+    // Reset values over n vertices to value
+    void reset(int n, T value)
+    {
+        if ((int)stamp.size() < n)
+        {
+            val.resize(n);
+            stamp.resize(n, 0);
+        }
+        init = value;
+
+        if (++epoch == 0)
+        {
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    T get(int j) const
+    {
+        return stamp[j] == epoch ? val[j] : init;
+    }
+
+    void set(int j, T value)
+    {
+        stamp[j] = epoch;
+        val[j] = value;
+    }
+};
+
+
+struct workspace{
+
+    // Matching of online vertices in the latest run, -1 for not matched
+    vector<int> res;
+
+    // Matched (or selected) vertices in the latest run
+    epoch_flags matched;
+
+    // Degree in MinDegree, number of arrivals of each type in Feldman et al. and Bahmani and Kapralov
+    epoch_array<int> count;
+
+    // Water level in Balance
+    epoch_array<double> level;
+
+    // Arena of buffers whose capacity persists across runs
+    // Valid mass of neighbors of the current arrival
+    vector<pair<int, double>> validMass;
+    // Cumulative probabilities of neighbors of the current arrival
+    vector<pair<double, int>> prob, prob2;
+    // Real values over vertices, e.g. offline and online mass in Regularized Greedy
+    vector<double> real1, real2;
+    // Integer values, e.g. ranks and sorted neighbors in Ranking
+    vector<int> int1, int2, int3, int4;
+
+    // Flow graph for offline optimal matching
+    flow_graph flow;
+
+    // Heavy neighbor in Correlated Sampling
+    int pivot;
+
+    // Random generator of runs using this workspace, so workspaces of different threads share no state
+    mt19937 gen;
+
+    // Number of arrivals of the current run processed so far
+    int next;
+
+    // Arrival before which the next call of an online algorithm stops, -1 for the end of realization
+    // A run can be split into several calls by raising stop between them, as in the fused evaluator
+    int stop;
+
+    // Seed the generator from the global rng
+    workspace() : flow(0, 1), gen(rng())
+    {
+        pivot = -1;
+        next = 0;
+        stop = -1;
+    }
+
+    // Prepare a run with n online vertices on a graph with size vertices
+    void start(int n, int size)
+    {
+        res.assign(n, -1);
+        matched.reset(size);
+    }
+
+    // Begin a call of an online algorithm with n online vertices on a graph with size vertices
+    // Return the first arrival to process, where 0 means a new run has been prepared
+    int begin(int n, int size)
+    {
+        if (stop == -1 || next >= n)
+            next = 0;
+        if (next == 0)
+            start(n, size);
+        return next;
+    }
+
+    // Return the arrival before which this call stops
+    int end(int n)
+    {
+        next = (stop == -1) ? n : min(stop, n);
+        return next;
+    }
+};